@@ -0,0 +1,273 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "dataset.hh"
+#include <array>
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
+
+namespace mm
+{
+namespace bookmarks
+{
+namespace benchmarks
+{
+random::random() = default;
+
+
+random::~random() = default;
+
+
+random::random(std::uint64_t const& seed) : m_state {seed} {}
+
+
+std::uint64_t random::next()
+{
+    std::uint64_t z = (m_state += 0x9E3779B97F4A7C15ULL);
+    z               = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z               = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+size_t random::uniform(size_t const& low, size_t const& high)
+{
+    return low + next() % (high - low + 1);
+}
+
+
+bool random::chance(double const& probability)
+{
+    return static_cast<double>(next() >> 11) * 0x1.0p-53 < probability;
+}
+
+
+namespace
+{
+std::array<char const*, 48> const words = {
+    "open",    "source",  "guide",   "release", "notes",   "home",
+    "page",    "docs",    "api",     "linux",   "kernel",  "news",
+    "weekly",  "recipe",  "travel",  "photo",   "gallery", "music",
+    "video",   "review",  "best",    "how",     "to",      "build",
+    "simple",  "fast",    "modern",  "project", "library", "tutorial",
+    "the",     "and",     "for",     "with",    "your",    "first",
+    "update",  "version", "manual",  "issue",   "forum",   "thread",
+    "archive", "search",  "account", "setting", "store",   "blog",
+};
+
+
+std::array<char const*, 6> const domains = {
+    ".com", ".org", ".net", ".io", ".dev", ".info"};
+
+
+std::string letters(random& random_, size_t const& low, size_t const& high)
+{
+    std::string result(random_.uniform(low, high), 'a');
+
+    for (auto& c : result)
+        c = static_cast<char>('a' + random_.uniform(0, 25));
+
+    return result;
+}
+
+
+// independent stream for every index
+random stream(std::uint64_t const& seed,
+              std::uint64_t const& domain,
+              size_t const&        index)
+{
+    random mixer {seed ^ (domain * 0xD6E8FEB86659FD93ULL)};
+    mixer.next();
+    return random {mixer.next() ^ (static_cast<std::uint64_t>(index) + 1) *
+                                      0x9E3779B97F4A7C15ULL};
+}
+} // namespace
+
+
+dataset::dataset() = default;
+
+
+dataset::~dataset() = default;
+
+
+void dataset::generate(manager& manager_, size_t const& chunk)
+{
+    auto const started = std::chrono::steady_clock::now();
+
+    containers.clear();
+    hosts = std::max<size_t>(1, rows / 100);
+
+    // one container for every twenty rows at most
+    size_t const budget = std::max<size_t>(1, rows / 20);
+
+    std::vector<std::string> parents = {"2"};
+
+    for (size_t level = 1; level <= depth && containers.size() < budget;
+         ++level)
+    {
+        std::string const prefix = "folder " + std::to_string(level) + ".";
+
+        std::vector<bookmark> folders {};
+
+        for (auto const& p : parents)
+            for (size_t f = 0; f < fanout; ++f)
+            {
+                if (containers.size() + folders.size() >= budget)
+                    break;
+
+                bookmark b {};
+                b.type      = sql::bookmarks::helpers::type::container;
+                b.container = p;
+                b.title     = prefix + std::to_string(folders.size());
+                folders.push_back(b);
+            }
+
+        if (folders.empty())
+            break;
+
+        manager_.insert_bookmarks(folders);
+
+        // identifiers are given by the database, titles tell them apart
+        std::vector<bookmark> const inserted = manager_.select_bookmarks(
+            comparison {similarity_type::PREFIX, "title", prefix},
+            {{"title", true}},
+            static_cast<unsigned int>(folders.size()),
+            0);
+
+        parents.assign(folders.size(), "");
+
+        for (auto const& v : inserted)
+            parents.at(std::stoul(v.title.substr(prefix.size()))) =
+                v.identifier;
+
+        containers.insert(containers.end(), parents.cbegin(), parents.cend());
+    }
+
+    if (containers.empty())
+        containers.push_back("2");
+
+    std::vector<bookmark> batch {};
+
+    for (size_t begin = 0; begin < urls(); begin += chunk)
+    {
+        size_t const end = std::min(urls(), begin + chunk);
+
+        batch.clear();
+
+        for (size_t i = begin; i < end; ++i)
+            batch.push_back(url_bookmark(i));
+
+        manager_.insert_bookmarks(batch);
+    }
+
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            started)
+                  .count();
+}
+
+
+size_t dataset::urls() const
+{
+    return (rows > containers.size()) ? rows - containers.size() : 0;
+}
+
+
+bookmark dataset::url_bookmark(size_t const& index) const
+{
+    random r = stream(seed, 1, index);
+
+    bookmark result {};
+
+    result.type      = sql::bookmarks::helpers::type::url;
+    result.container = containers.at(r.uniform(0, containers.size() - 1));
+    result.url       = url(index);
+    result.title     = title(r);
+
+    if (r.chance(0.15))
+        result.note = note(r);
+
+    return result;
+}
+
+
+std::string dataset::url(size_t const& index) const
+{
+    random r = stream(seed, 2, index);
+
+    std::string result = "https://" + host(r.uniform(0, hosts - 1)) + "/";
+
+    for (size_t i = 0, segments = r.uniform(1, 3); i < segments; ++i)
+        result += letters(r, 3, 10) + "/";
+
+    // the index keeps every url unique
+    result += letters(r, 4, 12) + "-" + std::to_string(index);
+
+    if (r.chance(0.3))
+        result += "?id=" + std::to_string(r.uniform(1, 999999));
+
+    return result;
+}
+
+
+std::string dataset::host(size_t const& index) const
+{
+    random r = stream(seed, 3, index);
+
+    std::string result = r.chance(0.5) ? "www." : "";
+    result += letters(r, 5, 12);
+    result += domains.at(r.uniform(0, domains.size() - 1));
+
+    return result;
+}
+
+
+std::string dataset::title(random& random_) const
+{
+    std::string result {};
+
+    for (size_t i = 0, count = random_.uniform(2, 8); i < count; ++i)
+    {
+        result += (i > 0) ? " " : "";
+        result += words.at(random_.uniform(0, words.size() - 1));
+    }
+
+    result.front() = static_cast<char>(result.front() - 'a' + 'A');
+
+    return result;
+}
+
+
+std::string dataset::note(random& random_) const
+{
+    std::string result {};
+
+    size_t const length = random_.uniform(40, 120);
+
+    while (result.size() < length)
+    {
+        result += result.empty() ? "" : " ";
+        result += words.at(random_.uniform(0, words.size() - 1));
+    }
+
+    return result;
+}
+} // namespace benchmarks
+} // namespace bookmarks
+} // namespace mm
@@ -0,0 +1,84 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <mm/bookmarks/bookmarks.hh>
+
+namespace mm
+{
+namespace bookmarks
+{
+namespace benchmarks
+{
+// splitmix64, the same sequence on every platform and standard library
+class random
+{
+public:
+    random();
+    ~random();
+
+    random(std::uint64_t const& seed);
+
+    std::uint64_t next();
+    // [low, high]
+    size_t uniform(size_t const& low, size_t const& high);
+    bool   chance(double const& probability);
+
+
+private:
+    std::uint64_t m_state = 0;
+};
+
+
+// synthetic bookmark tree, every row is derived from the seed and its
+// index alone, so any row can be produced again without storing it
+class dataset
+{
+public:
+    size_t        rows   = 10000;
+    size_t        depth  = 4;
+    size_t        fanout = 8;
+    std::uint64_t seed   = 1;
+
+    // filled by generate()
+    std::vector<std::string> containers = {};
+    size_t                   hosts      = 0;
+    double                   seconds    = 0.0;
+
+    dataset();
+    ~dataset();
+
+    // containers level by level, then urls spread over them in chunks
+    void generate(manager& manager_, size_t const& chunk = 20000);
+
+    size_t urls() const;
+
+    bookmark    url_bookmark(size_t const& index) const;
+    std::string url(size_t const& index) const;
+    std::string host(size_t const& index) const;
+    std::string title(random& random_) const;
+    std::string note(random& random_) const;
+};
+} // namespace benchmarks
+} // namespace bookmarks
+} // namespace mm
@@ -0,0 +1,669 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "dataset.hh"
+#include <mm/bookmarks/bookmarks.hh>
+#include <sqlite3.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bm = mm::bookmarks;
+namespace bb = mm::bookmarks::benchmarks;
+
+namespace
+{
+class options
+{
+public:
+    size_t        rows       = 10000;
+    size_t        depth      = 4;
+    size_t        fanout     = 8;
+    std::uint64_t seed       = 1;
+    size_t        iterations = 1000;
+    std::string   directory  = ".";
+    std::string   output     = {};
+    std::string   profile    = "throughput";
+    bool          help       = false;
+};
+
+
+class result
+{
+public:
+    std::string name       = {};
+    size_t      operations = 0;
+    size_t      rows       = 0;
+    double      seconds    = 0.0;
+};
+
+
+std::string const usage = R"EOF(usage: mmbookmarks_bench [options]
+
+    --rows <n>          bookmarks in the dataset, 10000
+    --depth <n>         container levels, 4
+    --fanout <n>        containers below each container, 8
+    --seed <n>          dataset seed, 1
+    --iterations <n>    calls of each select benchmark, 1000
+    --directory <path>  where the databases are created, .
+    --output <path>     JSON results, standard output when empty
+    --profile <name>    none, durable, throughput or read_mostly
+    --help              this text
+)EOF";
+
+
+options parse(int const& argc, char** argv)
+{
+    options result {};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const name = argv[i];
+
+        if (name == "--help")
+        {
+            result.help = true;
+            return result;
+        }
+
+        if (i + 1 >= argc)
+            throw std::runtime_error {"Missing value of " + name + "."};
+
+        std::string const value = argv[++i];
+
+        if (name == "--rows")
+            result.rows = std::stoul(value);
+        else if (name == "--depth")
+            result.depth = std::stoul(value);
+        else if (name == "--fanout")
+            result.fanout = std::stoul(value);
+        else if (name == "--seed")
+            result.seed = std::stoull(value);
+        else if (name == "--iterations")
+            result.iterations = std::max<size_t>(1, std::stoul(value));
+        else if (name == "--directory")
+            result.directory = value;
+        else if (name == "--output")
+            result.output = value;
+        else if (name == "--profile")
+            result.profile = value;
+        else
+            throw std::runtime_error {"Unknown option " + name + "."};
+    }
+
+    return result;
+}
+
+
+bm::connection_profile profile(std::string const& name)
+{
+    if (name == "none")
+        return bm::connection_profile::NONE;
+    if (name == "durable")
+        return bm::connection_profile::DURABLE;
+    if (name == "throughput")
+        return bm::connection_profile::THROUGHPUT;
+    if (name == "read_mostly")
+        return bm::connection_profile::READ_MOSTLY;
+    throw std::runtime_error {"Unknown profile " + name + "."};
+}
+
+
+void remove_database(std::string const& path)
+{
+    for (std::string const suffix : {"", "-wal", "-shm", "-journal"})
+        std::remove((path + suffix).c_str());
+}
+
+
+// work returns the rows it touched
+result measure(std::string const&              name,
+               size_t const&                   operations,
+               std::function<size_t()> const& work)
+{
+    std::cerr << "| Bench : " << name << std::endl;
+
+    auto const started = std::chrono::steady_clock::now();
+
+    result r {};
+    r.name       = name;
+    r.operations = operations;
+    r.rows       = work();
+    r.seconds    = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - started)
+                    .count();
+
+    return r;
+}
+
+
+std::string quoted(std::string const& text)
+{
+    std::string result = "\"";
+
+    for (auto const& c : text)
+    {
+        if (c == '"' || c == '\\')
+            result += std::string {'\\', c};
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char buffer[8] = {};
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            result += buffer;
+        }
+        else
+            result += c;
+    }
+
+    return result + "\"";
+}
+
+
+std::string number(double const& value)
+{
+    char buffer[32] = {};
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+
+class latency
+{
+public:
+    std::string               database  = {};
+    bm::statistics::operation operation = {};
+};
+
+
+std::string to_json(options const&              options_,
+                    bb::dataset const&          dataset_,
+                    std::vector<result> const&  results,
+                    std::vector<latency> const& latencies)
+{
+    std::ostringstream out {};
+
+    out << "{\n";
+    out << "  \"benchmark\": \"mmbookmarks\",\n";
+    out << "  \"sqlite\": " << quoted(sqlite3_libversion()) << ",\n";
+    out << "  \"parameters\": {\n";
+    out << "    \"rows\": " << options_.rows << ",\n";
+    out << "    \"depth\": " << options_.depth << ",\n";
+    out << "    \"fanout\": " << options_.fanout << ",\n";
+    out << "    \"seed\": " << options_.seed << ",\n";
+    out << "    \"iterations\": " << options_.iterations << ",\n";
+    out << "    \"profile\": " << quoted(options_.profile) << "\n";
+    out << "  },\n";
+    out << "  \"dataset\": {\n";
+    out << "    \"containers\": " << dataset_.containers.size() << ",\n";
+    out << "    \"urls\": " << dataset_.urls() << ",\n";
+    out << "    \"hosts\": " << dataset_.hosts << ",\n";
+    out << "    \"seconds\": " << number(dataset_.seconds) << "\n";
+    out << "  },\n";
+    out << "  \"results\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        result const& r = results.at(i);
+
+        double const seconds = (r.seconds > 0.0) ? r.seconds : 1e-9;
+
+        out << "    {\"name\": " << quoted(r.name)
+            << ", \"operations\": " << r.operations
+            << ", \"rows\": " << r.rows
+            << ", \"seconds\": " << number(r.seconds)
+            << ", \"operations_per_second\": "
+            << number(static_cast<double>(r.operations) / seconds)
+            << ", \"rows_per_second\": "
+            << number(static_cast<double>(r.rows) / seconds) << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    out << "  ],\n";
+    out << "  \"latency\": [\n";
+
+    for (size_t i = 0; i < latencies.size(); ++i)
+    {
+        bm::statistics::operation const& v = latencies.at(i).operation;
+
+        out << "    {\"database\": " << quoted(latencies.at(i).database)
+            << ", \"operation\": " << quoted(bm::enum_string(v.type))
+            << ", \"calls\": " << v.calls << ", \"errors\": " << v.errors
+            << ", \"p50\": " << number(v.p50)
+            << ", \"p90\": " << number(v.p90)
+            << ", \"p99\": " << number(v.p99)
+            << ", \"max\": " << number(v.max) << "}"
+            << (i + 1 < latencies.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+
+    return out.str();
+}
+
+
+// each manager reports its own operations, named after its database
+void append_latencies(std::vector<latency>& latencies,
+                      std::string const&    database,
+                      bm::statistics const& stats)
+{
+    for (auto const& v : stats.operations)
+        if (v.calls > 0)
+            latencies.push_back({database, v});
+}
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        options const options_ = parse(argc, argv);
+
+        if (options_.help)
+        {
+            std::cout << usage;
+            return 0;
+        }
+
+        bm::connection_options const connection {profile(options_.profile)};
+
+        std::string const source = "mm_bench.db";
+        std::string const target = "mm_bench_import.db";
+
+        remove_database(options_.directory + "/" + source);
+        remove_database(options_.directory + "/" + target);
+
+        std::vector<result>  results {};
+        std::vector<latency> latencies {};
+
+        bb::dataset dataset_ {};
+        dataset_.rows   = options_.rows;
+        dataset_.depth  = options_.depth;
+        dataset_.fanout = options_.fanout;
+        dataset_.seed   = options_.seed;
+
+        bm::manager manager_ {options_.directory, source, connection};
+
+        long long const started_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count();
+
+        std::cerr << "| Bench : dataset of " << options_.rows << " rows"
+                  << std::endl;
+
+        dataset_.generate(manager_);
+
+        bm::statistics::operation const inserted =
+            manager_.stats().at(bm::operation_type::INSERT);
+
+        results.push_back(
+            {"insert", inserted.calls, inserted.rows_in, inserted.seconds});
+
+        bb::random r {options_.seed};
+
+        size_t const iterations = options_.iterations;
+        size_t const urls       = dataset_.urls();
+
+        auto _container = [&]
+        {
+            return dataset_.containers.at(
+                r.uniform(0, dataset_.containers.size() - 1));
+        };
+
+        auto _url = [&] { return dataset_.url(r.uniform(0, urls - 1)); };
+
+        std::vector<std::pair<std::string, bool>> const by_title = {
+            {"title", true}};
+        std::vector<std::pair<std::string, bool>> const by_url = {
+            {"url", true}};
+
+        results.push_back(measure(
+            "select_container",
+            iterations,
+            [&]
+            {
+                size_t rows = 0;
+                for (size_t i = 0; i < iterations; ++i)
+                    rows += manager_
+                                .select_bookmarks(
+                                    bm::comparison {bm::similarity_type::EQUAL,
+                                                    "container",
+                                                    _container()},
+                                    by_title,
+                                    100,
+                                    0)
+                                .size();
+                return rows;
+            }));
+
+        results.push_back(measure(
+            "select_container_batch",
+            iterations,
+            [&]
+            {
+                size_t rows = 0;
+                for (size_t i = 0; i < iterations; ++i)
+                    rows += manager_
+                                .select_bookmarks_batch(
+                                    bm::comparison {bm::similarity_type::EQUAL,
+                                                    "container",
+                                                    _container()},
+                                    by_title,
+                                    100,
+                                    0)
+                                .size();
+                return rows;
+            }));
+
+        if (urls > 0)
+        {
+            results.push_back(measure(
+                "select_url",
+                iterations,
+                [&]
+                {
+                    size_t rows = 0;
+                    for (size_t i = 0; i < iterations; ++i)
+                        rows += manager_
+                                    .select_bookmarks(
+                                        bm::comparison {
+                                            bm::similarity_type::EQUAL,
+                                            "url",
+                                            _url()},
+                                        by_url,
+                                        1,
+                                        0)
+                                    .size();
+                    return rows;
+                }));
+
+            bm::query const compiled = manager_.prepare_query(
+                bm::comparison {bm::similarity_type::EQUAL, "url", "-"},
+                by_url);
+
+            results.push_back(measure(
+                "select_url_query",
+                iterations,
+                [&]
+                {
+                    size_t rows = 0;
+                    for (size_t i = 0; i < iterations; ++i)
+                        rows += manager_
+                                    .select_bookmarks(
+                                        compiled,
+                                        bm::comparison {
+                                            bm::similarity_type::EQUAL,
+                                            "url",
+                                            _url()},
+                                        1,
+                                        0)
+                                    .size();
+                    return rows;
+                }));
+
+            results.push_back(measure(
+                "select_url_in",
+                iterations,
+                [&]
+                {
+                    size_t rows = 0;
+                    for (size_t i = 0; i < iterations; ++i)
+                    {
+                        std::vector<std::string> values {};
+                        for (size_t v = 0; v < 16; ++v)
+                            values.push_back(_url());
+                        rows += manager_
+                                    .select_bookmarks(
+                                        bm::comparison {
+                                            bm::similarity_type::IN,
+                                            "url",
+                                            values},
+                                        by_url,
+                                        16,
+                                        0)
+                                    .size();
+                    }
+                    return rows;
+                }));
+        }
+
+        results.push_back(measure(
+            "select_url_prefix",
+            iterations,
+            [&]
+            {
+                size_t rows = 0;
+                for (size_t i = 0; i < iterations; ++i)
+                    rows += manager_
+                                .select_bookmarks(
+                                    bm::comparison {
+                                        bm::similarity_type::PREFIX,
+                                        "url",
+                                        "https://" +
+                                            dataset_.host(r.uniform(
+                                                0, dataset_.hosts - 1)) +
+                                            "/"},
+                                    by_url,
+                                    100,
+                                    0)
+                                .size();
+                return rows;
+            }));
+
+        long long const finished_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count();
+
+        results.push_back(measure(
+            "select_created_between",
+            iterations,
+            [&]
+            {
+                size_t rows = 0;
+                for (size_t i = 0; i < iterations; ++i)
+                {
+                    long long const from =
+                        started_ms +
+                        static_cast<long long>(r.uniform(
+                            0,
+                            static_cast<size_t>(finished_ms - started_ms)));
+                    rows += manager_
+                                .select_bookmarks(
+                                    bm::comparison {
+                                        bm::similarity_type::BETWEEN,
+                                        "created",
+                                        std::vector<std::string> {
+                                            std::to_string(from),
+                                            std::to_string(finished_ms)}},
+                                    {{"created", false}},
+                                    100,
+                                    0)
+                                .size();
+                }
+                return rows;
+            }));
+
+        // a full scan, fewer calls
+        size_t const scans = std::max<size_t>(1, iterations / 100);
+
+        results.push_back(measure(
+            "select_title_like",
+            scans,
+            [&]
+            {
+                size_t rows = 0;
+                for (size_t i = 0; i < scans; ++i)
+                    rows += manager_
+                                .select_bookmarks(
+                                    bm::comparison {bm::similarity_type::LIKE,
+                                                    "title",
+                                                    "%release%"},
+                                    by_title,
+                                    100,
+                                    0)
+                                .size();
+                return rows;
+            }));
+
+        results.push_back(measure(
+            "count_container",
+            iterations,
+            [&]
+            {
+                size_t rows = 0;
+                for (size_t i = 0; i < iterations; ++i)
+                    rows += manager_.count_bookmarks(
+                        bm::comparison {bm::similarity_type::EQUAL,
+                                        "container",
+                                        _container()});
+                return rows;
+            }));
+
+        results.push_back(measure(
+            "count_title_like",
+            scans,
+            [&]
+            {
+                size_t rows = 0;
+                for (size_t i = 0; i < scans; ++i)
+                    rows += manager_.count_bookmarks(
+                        bm::comparison {bm::similarity_type::LIKE,
+                                        "title",
+                                        "%release%"});
+                return rows;
+            }));
+
+        results.push_back(measure(
+            "page_container",
+            1,
+            [&]
+            {
+                bm::comparison const c {bm::similarity_type::EQUAL,
+                                        "container",
+                                        dataset_.containers.back()};
+                size_t      rows = 0;
+                std::string next {};
+                do
+                {
+                    bm::page const p = manager_.select_bookmarks_page(
+                        c, {"title", true}, 100, next);
+                    rows += p.bookmarks.size();
+                    next = p.cursor;
+                } while (!next.empty());
+                return rows;
+            }));
+
+        // the first tenth of the urls in url order, spread over the tree
+        size_t const sample =
+            std::min<size_t>(std::max<size_t>(1, urls / 10), 100000);
+
+        bm::bookmark_batch const sampled = manager_.select_bookmarks_batch(
+            bm::comparison {
+                bm::similarity_type::EQUAL, "type", "URL"},
+            by_url,
+            static_cast<unsigned int>(sample),
+            0);
+
+        std::vector<bm::bookmark> updates {};
+        for (size_t i = 0; i < sampled.size(); ++i)
+        {
+            bm::bookmark b {};
+            b.identifier = std::string {sampled.at(i).identifier};
+            b.title      = "Updated " + std::string {sampled.at(i).title};
+            updates.push_back(b);
+        }
+
+        results.push_back(measure("update",
+                                  1,
+                                  [&]
+                                  {
+                                      return manager_.update_bookmarks(updates)
+                                          .rows;
+                                  }));
+
+        std::vector<std::string> removed {};
+        for (size_t i = 0; i < sampled.size() && i < sample / 10 + 1; ++i)
+            removed.push_back(std::string {sampled.at(i).identifier});
+
+        results.push_back(measure("delete",
+                                  1,
+                                  [&]
+                                  {
+                                      return manager_.delete_bookmarks(removed)
+                                          .rows;
+                                  }));
+
+        results.push_back(measure("vacuum",
+                                  1,
+                                  [&]
+                                  {
+                                      manager_.vacuum_databases();
+                                      return size_t {0};
+                                  }));
+
+        append_latencies(latencies, source, manager_.stats());
+
+        manager_.close();
+
+        bm::manager imported {options_.directory, target, connection};
+
+        results.push_back(measure(
+            "import",
+            1,
+            [&]
+            {
+                imported.import_from(bm::source_type::MMBOOKMARKS,
+                                     options_.directory + "/" + source);
+                return imported.count_bookmarks(bm::comparison {
+                    bm::similarity_type::IS_NOT_NULL, "identifier"});
+            }));
+
+        append_latencies(latencies, target, imported.stats());
+
+        std::string const json =
+            to_json(options_, dataset_, results, latencies);
+
+        if (options_.output.empty())
+            std::cout << json;
+        else
+        {
+            std::ofstream file {options_.output};
+            if (!file)
+                throw std::runtime_error {"Can not open " + options_.output};
+            file << json;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "| Error : " << e.what() << std::endl;
+        std::cerr << usage;
+        return 1;
+    }
+
+    return 0;
+}
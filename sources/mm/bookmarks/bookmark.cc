@@ -18,6 +18,7 @@
 
 
 #include "bookmark.hh"
+#include "schema.hh"
 #include "utilities.hh"
 #include <mm/sqlite/utilities.hh>
 #include <stdexcept>
@@ -34,24 +35,21 @@ bookmark::~bookmark() = default;
 
 bookmark::bookmark(sqlite::row const& row_)
 {
-    for (auto v : row_.columns())
+    for (auto const& v : row_.columns())
     {
-        if (v.first == "identifier")
-            identifier = v.second.value();
-        else if (v.first == "container")
-            container = v.second.value();
-        else if (v.first == "type")
-            type = v.second.value();
-        else if (v.first == "url")
-            url = v.second.value();
-        else if (v.first == "title")
-            title = v.second.value();
-        else if (v.first == "note")
-            note = v.second.value();
-        else if (v.first == "created")
-            created = v.second.value();
-        else if (v.first == "modified")
-            modified = v.second.value();
+        size_t const index = schema::find(v.first);
+
+        if (index == schema::npos)
+            continue;
+
+        field const& f = schema::fields[index];
+
+        // rows of older schemas still carry text
+        if (f.type == sqlite::data_type::INTEGER && !v.second.value().empty())
+            this->*f.member =
+                format_timestamp(parse_timestamp(v.second.value()));
+        else
+            this->*f.member = v.second.value();
     }
 }
 
@@ -61,29 +59,22 @@ sqlite::row bookmark::to_row(bool const&        assign_parameters,
 {
     sqlite::row result {};
 
-    static auto _col = [&](std::string const&       name_,
-                           std::string const&       value_,
-                           sqlite::data_type const& type_,
-                           bool const&              allow_empty = false)
+    for (auto const& f : schema::fields)
     {
-        if (!allow_empty && value_.empty())
-            return;
+        std::string const& value = this->*f.member;
+
+        if (!f.nullable && value.empty())
+            continue;
+
         result.append(
-            name_,
+            f.name,
             sqlite::column {
-                value_,
-                type_,
-                (assign_parameters ? form_parameter(name_, postfix) : "")});
-    };
-
-    _col("identifier", identifier, sqlite::data_type::TEXT);
-    _col("container", container, sqlite::data_type::TEXT);
-    _col("type", type, sqlite::data_type::TEXT);
-    _col("url", url, sqlite::data_type::TEXT, true);
-    _col("title", title, sqlite::data_type::TEXT, true);
-    _col("note", note, sqlite::data_type::TEXT, true);
-    _col("created", created, sqlite::data_type::TEXT);
-    _col("modified", modified, sqlite::data_type::TEXT);
+                (f.type == sqlite::data_type::INTEGER)
+                    ? std::to_string(parse_timestamp(value))
+                    : value,
+                f.type,
+                (assign_parameters ? form_parameter(f.name, postfix) : "")});
+    }
 
     return result;
 }
@@ -91,10 +82,16 @@ sqlite::row bookmark::to_row(bool const&        assign_parameters,
 
 void bookmark::valid_key(std::string const& key)
 {
-    if (!(key == "identifier" || key == "container" || key == "type" ||
-          key == "url" || key == "title" || key == "note" || key == "created" ||
-          key == "modified"))
+    if (schema::find(key) == schema::npos)
         throw std::runtime_error {"Invalid key for bookmark."};
 }
+
+
+bool bookmark::timestamp_key(std::string const& key)
+{
+    size_t const index = schema::find(key);
+    return index != schema::npos &&
+           schema::fields[index].type == sqlite::data_type::INTEGER;
+}
 } // namespace bookmarks
 } // namespace mm
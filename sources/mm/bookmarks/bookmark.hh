@@ -47,6 +47,8 @@ public:
                        std::string const& postfix           = "") const;
 
     static void valid_key(std::string const& key);
+    // stored as epoch milliseconds, exposed as ISO 8601
+    static bool timestamp_key(std::string const& key);
 };
 } // namespace bookmarks
 } // namespace mm
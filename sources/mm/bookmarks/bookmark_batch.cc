@@ -0,0 +1,114 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "bookmark_batch.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+bookmark_batch::bookmark_batch() = default;
+
+
+bookmark_batch::~bookmark_batch() = default;
+
+
+size_t bookmark_batch::size() const
+{
+    return m_columns.at(0).offsets.size() - 1;
+}
+
+
+bool bookmark_batch::empty() const { return size() == 0; }
+
+
+void bookmark_batch::clear()
+{
+    for (auto& v : m_columns)
+    {
+        v.arena.clear();
+        v.offsets.assign(1, 0);
+    }
+}
+
+
+void bookmark_batch::reserve(size_t const& rows)
+{
+    for (auto& v : m_columns)
+        v.offsets.reserve(rows + 1);
+}
+
+
+void bookmark_batch::append(bookmark const& bookmark_)
+{
+    for (size_t f = 0; f < m_columns.size(); ++f)
+    {
+        m_columns.at(f).arena += bookmark_.*(schema::fields[f].member);
+        m_columns.at(f).offsets.push_back(m_columns.at(f).arena.size());
+    }
+}
+
+
+std::string_view bookmark_batch::field(size_t const& index,
+                                       size_t const& field_) const
+{
+    column const& c = m_columns.at(field_);
+
+    size_t const begin = c.offsets.at(index);
+    size_t const end   = c.offsets.at(index + 1);
+
+    return std::string_view {c.arena}.substr(begin, end - begin);
+}
+
+
+bookmark_batch::view bookmark_batch::at(size_t const& index) const
+{
+    view result {};
+
+    result.identifier = field(index, 0);
+    result.container  = field(index, 1);
+    result.type       = field(index, 2);
+    result.url        = field(index, 3);
+    result.title      = field(index, 4);
+    result.note       = field(index, 5);
+    result.created    = field(index, 6);
+    result.modified   = field(index, 7);
+
+    return result;
+}
+
+
+bookmark_batch::column const& bookmark_batch::columns(
+    size_t const& field_) const
+{
+    return m_columns.at(field_);
+}
+
+
+bookmark bookmark_batch::to_bookmark(size_t const& index) const
+{
+    bookmark result {};
+
+    for (size_t f = 0; f < schema::fields.size(); ++f)
+        result.*(schema::fields[f].member) = std::string {field(index, f)};
+
+    return result;
+}
+} // namespace bookmarks
+} // namespace mm
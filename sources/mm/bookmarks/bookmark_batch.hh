@@ -0,0 +1,83 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <string_view>
+#include "bookmark.hh"
+#include "schema.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+// structure of arrays result, every column keeps its values back to back
+// in one arena and a row's value is found by offsets[row, row + 1)
+class bookmark_batch
+{
+public:
+    class column
+    {
+    public:
+        std::string         arena   = {};
+        std::vector<size_t> offsets = {0};
+    };
+
+    // a row, valid as long as the batch is not modified
+    class view
+    {
+    public:
+        std::string_view identifier = {};
+        std::string_view container  = {};
+        std::string_view type       = {};
+        std::string_view url        = {};
+        std::string_view title      = {};
+        std::string_view note       = {};
+        std::string_view created    = {};
+        std::string_view modified   = {};
+    };
+
+    bookmark_batch();
+    ~bookmark_batch();
+
+    size_t size() const;
+    bool   empty() const;
+    void   clear();
+    void   reserve(size_t const& rows);
+
+    void append(bookmark const& bookmark_);
+
+    std::string_view field(size_t const& index, size_t const& field_) const;
+    view             at(size_t const& index) const;
+    column const&    columns(size_t const& field_) const;
+
+    bookmark to_bookmark(size_t const& index) const;
+
+
+private:
+    friend class manager;
+
+    // in order of schema::fields
+    std::array<column, schema::fields.size()> m_columns = {};
+};
+} // namespace bookmarks
+} // namespace mm
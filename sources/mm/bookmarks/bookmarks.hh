@@ -24,5 +24,19 @@
 #include "enums.hh"
 #include "utilities.hh"
 #include "comparison.hh"
+#include "query.hh"
+#include "query_plan.hh"
+#include "statistics.hh"
+#include "report.hh"
+#include "connection_options.hh"
+#include "cursor.hh"
+#include "search_result.hh"
+#include "tree.hh"
+#include "bookmark_batch.hh"
+#include "statement.hh"
+#include "statement_cache.hh"
+#include "listing_cache.hh"
+#include "transaction.hh"
 #include "bookmark.hh"
 #include "manager.hh"
+#include "write_queue.hh"
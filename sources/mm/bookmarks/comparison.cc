@@ -19,6 +19,7 @@
 
 #include "comparison.hh"
 #include "utilities.hh"
+#include "bookmark.hh"
 #include <mm/sqlite/utilities.hh>
 #include <stdexcept>
 
@@ -53,6 +54,33 @@ comparison::comparison(similarity_type const& type,
 }
 
 
+comparison::comparison(similarity_type const& type, std::string const& key)
+{
+    set(type, key, std::string {});
+}
+
+
+comparison::comparison(similarity_type const&  type,
+                       std::string const&      key,
+                       std::vector<int> const& values)
+{
+    std::vector<std::string> values_ {};
+
+    for (auto const& v : values)
+        values_.push_back(std::to_string(v));
+
+    set(type, key, values_, sqlite::data_type::INTEGER);
+}
+
+
+comparison::comparison(similarity_type const&          type,
+                       std::string const&              key,
+                       std::vector<std::string> const& values)
+{
+    set(type, key, values, sqlite::data_type::TEXT);
+}
+
+
 void comparison::set(similarity_type const& type,
                      std::string const&     key,
                      int const&             value)
@@ -84,12 +112,54 @@ void comparison::set(similarity_type const&   type,
 {
     sqlite::valid_sqlite_identifier(key);
 
+    if (type == similarity_type::PREFIX &&
+        (value.empty() || bookmark::timestamp_key(key)))
+        throw std::runtime_error {"Prefix needs a non empty text value."};
+    if (type == similarity_type::BETWEEN)
+        throw std::runtime_error {"BETWEEN needs two values."};
+
     m_type   = type;
     m_key    = key;
     m_column = sqlite::column {value, data_type_};
+
+    m_columns.clear();
+
+    if (type == similarity_type::IN)
+        m_columns.push_back(m_column);
+}
+
+
+void comparison::set(similarity_type const&          type,
+                     std::string const&              key,
+                     std::vector<std::string> const& values,
+                     sqlite::data_type const&        data_type_)
+{
+    if (type != similarity_type::IN && type != similarity_type::BETWEEN)
+        throw std::runtime_error {"Value list needs IN or BETWEEN."};
+    if (values.empty())
+        throw std::runtime_error {"Value list can not be empty."};
+    if (type == similarity_type::BETWEEN && values.size() != 2)
+        throw std::runtime_error {"BETWEEN needs two values."};
+
+    sqlite::valid_sqlite_identifier(key);
+
+    m_type   = type;
+    m_key    = key;
+    m_column = sqlite::column {};
+
+    m_columns.clear();
+
+    for (auto const& v : values)
+        m_columns.push_back(sqlite::column {v, data_type_});
 }
 
 
+void comparison::negated(bool const& enable) { m_negated = enable; }
+
+
+bool comparison::negated() const { return m_negated; }
+
+
 void comparison::append(logical_type const& type, comparison const& other)
 {
     m_other_comparisons.push_back(
@@ -104,22 +174,25 @@ std::pair<std::string, sqlite::row>
 
     std::pair<std::string, sqlite::row> result {};
 
-    std::string       value = m_column.value();
-    sqlite::data_type type  = m_column.type();
+    std::vector<sqlite::column> const values = bound();
+    std::vector<std::string>          slots {};
 
-    if (m_type == similarity_type::LIKE)
+    for (size_t i = 0; i < values.size(); ++i)
     {
-        value = "%" + value + "%";
-        type  = sqlite::data_type::TEXT;
-    }
+        // single values keep their historical parameter names
+        std::string const postfix =
+            std::to_string(internal_postfix) +
+            (values.size() > 1 ? "_" + std::to_string(i) : "");
 
-    sqlite::column col {
-        value, type, form_parameter(m_key, std::to_string(internal_postfix))};
+        sqlite::column col {values.at(i).value(),
+                            values.at(i).type(),
+                            form_parameter(m_key, postfix)};
 
-    result.first =
-        "[" + m_key + "]" + enum_string(m_type) + ":" + col.parameter();
+        slots.push_back(":" + col.parameter());
+        result.second.append(col.parameter(), col);
+    }
 
-    result.second.append(col.parameter(), col);
+    result.first = expression(slots);
 
     for (auto const& v : m_other_comparisons)
     {
@@ -137,9 +210,186 @@ std::pair<std::string, sqlite::row>
     if (result.first.empty())
         throw std::runtime_error {"Empty comparison statement."};
 
-    result.first = "(" + result.first + ")";
+    result.first = (m_negated ? "NOT (" : "(") + result.first + ")";
+
+    return result;
+}
+
+
+std::string comparison::compile() const
+{
+    std::string result {};
+    size_t      slot = 0;
+
+    compile(result, slot);
 
     return result;
 }
+
+
+std::vector<sqlite::column> comparison::values() const
+{
+    std::vector<sqlite::column> result {};
+    result.reserve(m_other_comparisons.size() + 1);
+
+    values(result);
+
+    return result;
+}
+
+
+bool comparison::same_shape(comparison const& other) const
+{
+    if (m_type != other.m_type || m_key != other.m_key ||
+        m_negated != other.m_negated ||
+        m_columns.size() != other.m_columns.size() ||
+        m_other_comparisons.size() != other.m_other_comparisons.size())
+        return false;
+
+    for (size_t i = 0; i < m_other_comparisons.size(); ++i)
+        if (m_other_comparisons.at(i).first !=
+                other.m_other_comparisons.at(i).first ||
+            !m_other_comparisons.at(i).second.same_shape(
+                other.m_other_comparisons.at(i).second))
+            return false;
+
+    return true;
+}
+
+
+void comparison::compile(std::string& sql, size_t& slot) const
+{
+    sqlite::valid_sqlite_identifier(m_key);
+
+    std::vector<std::string> slots(bound().size());
+
+    for (auto& v : slots)
+        v = "?" + std::to_string(++slot);
+
+    sql += (m_negated ? "NOT (" : "(") + expression(slots);
+
+    for (auto const& v : m_other_comparisons)
+    {
+        sql += enum_string(v.first);
+        v.second.compile(sql, slot);
+    }
+
+    sql += ")";
+}
+
+
+void comparison::values(std::vector<sqlite::column>& result) const
+{
+    std::vector<sqlite::column> const values_ = bound();
+
+    result.insert(result.end(), values_.cbegin(), values_.cend());
+
+    for (auto const& v : m_other_comparisons)
+        v.second.values(result);
+}
+
+
+std::vector<sqlite::column> comparison::bound() const
+{
+    // compared as integers, which an index can range scan
+    auto _timestamp = [&](sqlite::column const& column_)
+    {
+        if (bookmark::timestamp_key(m_key) && !column_.value().empty() &&
+            column_.type() == sqlite::data_type::TEXT)
+            return sqlite::column {
+                std::to_string(parse_timestamp(column_.value())),
+                sqlite::data_type::INTEGER};
+        return column_;
+    };
+
+    std::vector<sqlite::column> result {};
+
+    switch (m_type)
+    {
+    case similarity_type::LIKE:
+        result.push_back(sqlite::column {"%" + m_column.value() + "%",
+                                         sqlite::data_type::TEXT});
+        break;
+    case similarity_type::IN:
+    case similarity_type::BETWEEN:
+        for (auto const& v : m_columns)
+            result.push_back(_timestamp(v));
+        break;
+    case similarity_type::PREFIX:
+    {
+        // smallest string above every string starting with the prefix
+        std::string upper = m_column.value();
+
+        while (!upper.empty() &&
+               static_cast<unsigned char>(upper.back()) == 0xFF)
+            upper.pop_back();
+
+        if (upper.empty())
+            throw std::runtime_error {"Invalid prefix."};
+
+        upper.back() = static_cast<char>(
+            static_cast<unsigned char>(upper.back()) + 1);
+
+        result.push_back(
+            sqlite::column {m_column.value(), sqlite::data_type::TEXT});
+        result.push_back(sqlite::column {upper, sqlite::data_type::TEXT});
+        break;
+    }
+    case similarity_type::IS_NULL:
+    case similarity_type::IS_NOT_NULL:
+        break;
+    default:
+        result.push_back(_timestamp(m_column));
+        break;
+    }
+
+    return result;
+}
+
+
+std::string comparison::expression(std::vector<std::string> const& slots) const
+{
+    std::string const column_ = "[" + m_key + "]";
+
+    switch (m_type)
+    {
+    case similarity_type::IN:
+    {
+        std::string result = column_ + enum_string(m_type) + "(";
+        for (size_t i = 0; i < slots.size(); ++i)
+            result += (i > 0 ? ", " : "") + slots.at(i);
+        return result + ")";
+    }
+    case similarity_type::BETWEEN:
+        return column_ + enum_string(m_type) + slots.at(0) + " AND " +
+               slots.at(1);
+    case similarity_type::PREFIX:
+        return "(" + column_ + " >= " + slots.at(0) + " AND " + column_ +
+               " < " + slots.at(1) + ")";
+    case similarity_type::IS_NULL:
+    case similarity_type::IS_NOT_NULL:
+        return column_ + enum_string(m_type);
+    default:
+        return column_ + enum_string(m_type) + slots.at(0);
+    }
+}
+
+
+similarity_type const& comparison::type() const { return m_type; }
+
+
+std::string const& comparison::key() const { return m_key; }
+
+
+sqlite::column const& comparison::column() const { return m_column; }
+
+
+std::vector<sqlite::column> const& comparison::columns() const
+{
+    return m_columns;
+}
+
+
+bool comparison::compound() const { return !m_other_comparisons.empty(); }
 } // namespace bookmarks
 } // namespace mm
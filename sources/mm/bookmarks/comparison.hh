@@ -46,6 +46,15 @@ public:
     comparison(similarity_type const& type,
                std::string const&     key,
                std::string const&     value);
+    // IS_NULL and IS_NOT_NULL
+    comparison(similarity_type const& type, std::string const& key);
+    // IN and BETWEEN
+    comparison(similarity_type const&  type,
+               std::string const&      key,
+               std::vector<int> const& values);
+    comparison(similarity_type const&          type,
+               std::string const&              key,
+               std::vector<std::string> const& values);
 
     void set(similarity_type const& type,
              std::string const&     key,
@@ -60,17 +69,49 @@ public:
              std::string const&       key,
              std::string const&       value,
              sqlite::data_type const& data_type_);
+    void set(similarity_type const&          type,
+             std::string const&              key,
+             std::vector<std::string> const& values,
+             sqlite::data_type const&        data_type_);
+
+    // NOT over this comparison and the ones appended to it
+    void negated(bool const& enable);
+    bool negated() const;
 
     void append(logical_type const& type, comparison const& other);
 
     std::pair<std::string, sqlite::row>
         statement_and_row(unsigned int const& __internal_postfix = 0) const;
 
+    // where clause with numbered slots ?1, ?2 ..., equal for equal shapes
+    std::string compile() const;
+    // values to bind, in slot order
+    std::vector<sqlite::column> values() const;
+    // same keys, similarity and logical types, values aside
+    bool same_shape(comparison const& other) const;
+
+    similarity_type const& type() const;
+    std::string const&     key() const;
+    sqlite::column const&  column() const;
+    // value list of IN and BETWEEN
+    std::vector<sqlite::column> const& columns() const;
+    // joined with other comparisons
+    bool compound() const;
+
 
 private:
-    similarity_type m_type   = similarity_type::NONE;
-    std::string     m_key    = {};
-    sqlite::column  m_column = {};
+    void compile(std::string& sql, size_t& slot) const;
+    void values(std::vector<sqlite::column>& result) const;
+    // values as compared, LIKE patterns, prefix bounds, integer timestamps
+    std::vector<sqlite::column> bound() const;
+    // this comparison alone, placeholders in the order of bound()
+    std::string expression(std::vector<std::string> const& slots) const;
+
+    similarity_type             m_type    = similarity_type::NONE;
+    std::string                 m_key     = {};
+    sqlite::column              m_column  = {};
+    std::vector<sqlite::column> m_columns = {};
+    bool                        m_negated = false;
     std::vector<std::pair<logical_type, comparison>> m_other_comparisons = {};
 };
 } // namespace bookmarks
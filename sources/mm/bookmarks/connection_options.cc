@@ -0,0 +1,152 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "connection_options.hh"
+#include "utilities.hh"
+#include <mm/sqlite/utilities.hh>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+
+namespace mm
+{
+namespace bookmarks
+{
+connection_options::connection_options() = default;
+
+
+connection_options::~connection_options() = default;
+
+
+connection_options::connection_options(connection_profile const& profile)
+{
+    switch (profile)
+    {
+    // the connection is left as opened
+    case connection_profile::NONE:
+        break;
+    case connection_profile::DURABLE:
+        journal_mode = "WAL";
+        synchronous  = "FULL";
+        cache_size   = -16384;
+        mmap_size    = 0;
+        temp_store   = "DEFAULT";
+        break;
+    case connection_profile::THROUGHPUT:
+        journal_mode = "WAL";
+        synchronous  = "NORMAL";
+        cache_size   = -65536;
+        mmap_size    = 268435456;
+        temp_store   = "MEMORY";
+        break;
+    case connection_profile::READ_MOSTLY:
+        journal_mode = "WAL";
+        synchronous  = "NORMAL";
+        cache_size   = -131072;
+        mmap_size    = 1073741824;
+        temp_store   = "MEMORY";
+        break;
+    default:
+        throw std::runtime_error {"Invalid connection profile."};
+    }
+}
+
+
+void connection_options::apply(sqlite::database& database,
+                               bool const&       read_only) const
+{
+    // pragma values can not be bound, only known keywords are accepted
+    static auto _keyword = [](std::string const&              value,
+                              std::vector<std::string> const& allowed)
+    {
+        std::string const result = uppercase(value);
+        if (std::find(allowed.cbegin(), allowed.cend(), result) ==
+            allowed.cend())
+            throw std::runtime_error {"Invalid connection option."};
+        return result;
+    };
+
+    // file level settings belong to the writer
+    if (!read_only)
+    {
+        // page size has to be set before the database is written
+        if (page_size)
+            database.execute("PRAGMA page_size = " +
+                             std::to_string(*page_size) + ";");
+        if (journal_mode)
+            database.execute(
+                "PRAGMA journal_mode = " +
+                _keyword(*journal_mode,
+                         {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL",
+                          "OFF"}) +
+                ";");
+        if (synchronous)
+            database.execute(
+                "PRAGMA synchronous = " +
+                _keyword(*synchronous, {"OFF", "NORMAL", "FULL", "EXTRA"}) +
+                ";");
+    }
+
+    if (cache_size)
+        database.execute("PRAGMA cache_size = " + std::to_string(*cache_size) +
+                         ";");
+    if (mmap_size)
+        database.execute("PRAGMA mmap_size = " + std::to_string(*mmap_size) +
+                         ";");
+    if (temp_store)
+        database.execute(
+            "PRAGMA temp_store = " +
+            _keyword(*temp_store, {"DEFAULT", "FILE", "MEMORY"}) + ";");
+}
+
+
+connection_options connection_options::effective(sqlite::database& database)
+{
+    static auto _pragma = [](sqlite::database&  database_,
+                             std::string const& name,
+                             std::string const& fallback = "0")
+    {
+        std::vector<sqlite::row> const rows =
+            database_.execute("PRAGMA " + name + ";");
+        if (rows.empty() || rows.at(0).columns().empty())
+            return fallback;
+        return rows.at(0).columns().begin()->second.value();
+    };
+
+    static std::vector<std::string> const synchronous_names = {
+        "OFF", "NORMAL", "FULL", "EXTRA"};
+    static std::vector<std::string> const temp_store_names = {
+        "DEFAULT", "FILE", "MEMORY"};
+
+    connection_options result {};
+
+    result.journal_mode =
+        uppercase(_pragma(database, "journal_mode", "DELETE"));
+    result.synchronous  = synchronous_names.at(
+        static_cast<size_t>(sqlite::to_int(_pragma(database, "synchronous"))));
+    result.cache_size = std::stoll(_pragma(database, "cache_size"));
+    result.mmap_size  = std::stoll(_pragma(database, "mmap_size"));
+    result.temp_store = temp_store_names.at(
+        static_cast<size_t>(sqlite::to_int(_pragma(database, "temp_store"))));
+    result.page_size = std::stoll(_pragma(database, "page_size"));
+
+    return result;
+}
+} // namespace bookmarks
+} // namespace mm
@@ -0,0 +1,57 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <optional>
+#include "enums.hh"
+#include <mm/sqlite/database.hh>
+
+namespace mm
+{
+namespace bookmarks
+{
+// connection level pragmas, unset values are left as the file or
+// sqlite has them, profiles set all but page_size
+class connection_options
+{
+public:
+    std::optional<std::string> journal_mode = {};
+    std::optional<std::string> synchronous  = {};
+    std::optional<long long>   cache_size   = {}; // pages, or KiB when < 0
+    std::optional<long long>   mmap_size    = {}; // bytes
+    std::optional<std::string> temp_store   = {};
+    std::optional<long long>   page_size    = {}; // only for new databases
+
+    // read-only connections besides the writer, WAL journal only
+    size_t readers = 0;
+
+    connection_options();
+    ~connection_options();
+
+    connection_options(connection_profile const& profile);
+
+    void apply(sqlite::database& database,
+               bool const&       read_only = false) const;
+
+    static connection_options effective(sqlite::database& database);
+};
+} // namespace bookmarks
+} // namespace mm
@@ -0,0 +1,120 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "cursor.hh"
+#include <stdexcept>
+
+namespace mm
+{
+namespace bookmarks
+{
+namespace
+{
+char const* const hex_digits = "0123456789abcdef";
+
+
+std::string hex_encode(std::string const& str)
+{
+    std::string result {};
+    result.reserve(str.size() * 2);
+
+    for (auto const& c : str)
+    {
+        auto const u = static_cast<unsigned char>(c);
+        result += hex_digits[u >> 4];
+        result += hex_digits[u & 0x0f];
+    }
+
+    return result;
+}
+
+
+std::string hex_decode(std::string const& str)
+{
+    static auto _nibble = [](char const& c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        throw std::runtime_error {"Invalid cursor."};
+    };
+
+    if (str.size() % 2 != 0)
+        throw std::runtime_error {"Invalid cursor."};
+
+    std::string result {};
+    result.reserve(str.size() / 2);
+
+    for (size_t i = 0; i < str.size(); i += 2)
+        result += static_cast<char>((_nibble(str.at(i)) << 4) |
+                                    _nibble(str.at(i + 1)));
+
+    return result;
+}
+} // namespace
+
+
+cursor::cursor() = default;
+
+
+cursor::~cursor() = default;
+
+
+cursor::cursor(std::string const& token)
+{
+    // key.flags.value.identifier
+    std::vector<std::string> parts {};
+
+    size_t begin = 0;
+
+    while (true)
+    {
+        size_t const end = token.find('.', begin);
+        parts.push_back(token.substr(begin, end - begin));
+        if (end == std::string::npos)
+            break;
+        begin = end + 1;
+    }
+
+    if (parts.size() != 4 || parts.at(1).size() != 2 ||
+        parts.at(1).find_first_not_of("adnv") != std::string::npos)
+        throw std::runtime_error {"Invalid cursor."};
+
+    key        = hex_decode(parts.at(0));
+    ascending  = (parts.at(1).at(0) == 'a');
+    null_value = (parts.at(1).at(1) == 'n');
+    value      = hex_decode(parts.at(2));
+    identifier = hex_decode(parts.at(3));
+
+    bookmark::valid_key(key);
+}
+
+
+std::string cursor::token() const
+{
+    std::string flags {};
+    flags += ascending ? 'a' : 'd';
+    flags += null_value ? 'n' : 'v';
+
+    return hex_encode(key) + "." + flags + "." + hex_encode(value) + "." +
+           hex_encode(identifier);
+}
+} // namespace bookmarks
+} // namespace mm
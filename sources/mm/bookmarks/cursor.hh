@@ -0,0 +1,59 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "bookmark.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+// position after the last row of a keyset page
+class cursor
+{
+public:
+    std::string key        = {};
+    bool        ascending  = true;
+    bool        null_value = false;
+    std::string value      = {};
+    std::string identifier = {};
+
+    cursor();
+    ~cursor();
+
+    cursor(std::string const& token);
+
+    // opaque continuation token
+    std::string token() const;
+};
+
+
+class page
+{
+public:
+    std::vector<bookmark> bookmarks = {};
+
+    // empty when there are no more rows
+    std::string cursor = {};
+};
+} // namespace bookmarks
+} // namespace mm
@@ -26,6 +26,9 @@ namespace mm
 {
 namespace bookmarks
 {
+// IN takes a value list, BETWEEN two inclusive bounds, IS_NULL and
+// IS_NOT_NULL none, PREFIX is anchored and compared as a range, which
+// the url and title indexes serve
 enum class similarity_type
 {
     NONE               = 0,
@@ -36,6 +39,11 @@ enum class similarity_type
     MORE_THAN          = 5,
     MORE_THAN_OR_EQUAL = 6,
     LIKE               = 7,
+    IN                 = 8,
+    BETWEEN            = 9,
+    PREFIX             = 10,
+    IS_NULL            = 11,
+    IS_NOT_NULL        = 12,
 };
 
 
@@ -57,6 +65,14 @@ inline std::string enum_string(similarity_type const& type)
         return " >= ";
     case similarity_type::LIKE:
         return " LIKE ";
+    case similarity_type::IN:
+        return " IN ";
+    case similarity_type::BETWEEN:
+        return " BETWEEN ";
+    case similarity_type::IS_NULL:
+        return " IS NULL";
+    case similarity_type::IS_NOT_NULL:
+        return " IS NOT NULL";
     default:
         throw std::runtime_error {"Invalid similarity check."};
     }
@@ -85,6 +101,86 @@ inline std::string enum_string(logical_type const& type)
 }
 
 
+enum class connection_profile
+{
+    NONE        = 0,
+    DURABLE     = 1,
+    THROUGHPUT  = 2,
+    READ_MOSTLY = 3,
+};
+
+
+enum class timestamp_type
+{
+    NONE     = 0,
+    CREATED  = 1,
+    MODIFIED = 2,
+};
+
+
+inline std::string enum_string(timestamp_type const& type)
+{
+    switch (type)
+    {
+    case timestamp_type::CREATED:
+        return "created";
+    case timestamp_type::MODIFIED:
+        return "modified";
+    default:
+        throw std::runtime_error {"Invalid timestamp."};
+    }
+}
+
+
+enum class operation_type
+{
+    NONE    = 0,
+    INSERT  = 1,
+    UPDATE  = 2,
+    DELETE  = 3,
+    MOVE    = 4,
+    SELECT  = 5,
+    PAGE    = 6,
+    COUNT   = 7,
+    BETWEEN = 8,
+    SUBTREE = 9,
+    SEARCH  = 10,
+    IMPORT  = 11,
+};
+
+
+inline std::string enum_string(operation_type const& type)
+{
+    switch (type)
+    {
+    case operation_type::INSERT:
+        return "insert";
+    case operation_type::UPDATE:
+        return "update";
+    case operation_type::DELETE:
+        return "delete";
+    case operation_type::MOVE:
+        return "move";
+    case operation_type::SELECT:
+        return "select";
+    case operation_type::PAGE:
+        return "page";
+    case operation_type::COUNT:
+        return "count";
+    case operation_type::BETWEEN:
+        return "between";
+    case operation_type::SUBTREE:
+        return "subtree";
+    case operation_type::SEARCH:
+        return "search";
+    case operation_type::IMPORT:
+        return "import";
+    default:
+        throw std::runtime_error {"Invalid operation."};
+    }
+}
+
+
 enum class source_type
 {
     NONE           = 0,
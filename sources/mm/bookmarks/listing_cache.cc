@@ -0,0 +1,209 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "listing_cache.hh"
+#include <sqlite3.h>
+
+namespace mm
+{
+namespace bookmarks
+{
+listing_cache::listing_cache() = default;
+
+
+listing_cache::~listing_cache() = default;
+
+
+std::shared_ptr<listing_cache::listing const>
+    listing_cache::find(std::string const& key)
+{
+    auto found = m_index.find(key);
+
+    if (found == m_index.end())
+    {
+        ++m_misses;
+        return nullptr;
+    }
+
+    ++m_hits;
+    m_entries.splice(m_entries.begin(), m_entries, found->second);
+    return found->second->value;
+}
+
+
+void listing_cache::insert(std::string const&                    key,
+                           std::string const&                    container,
+                           std::shared_ptr<listing const> const& value,
+                           std::vector<long long> const&         rowids,
+                           bool const&                           complete)
+{
+    auto found = m_index.find(key);
+
+    if (found != m_index.end())
+        erase(found->second);
+
+    size_t const bytes = footprint(*value) + key.size() + container.size() +
+                         rowids.size() * sizeof(long long);
+
+    // would not fit even alone
+    if (bytes > m_budget)
+        return;
+
+    m_entries.push_front(
+        entry {key, container, value, rowids, bytes, complete});
+    m_index[key] = m_entries.begin();
+    m_bytes += bytes;
+
+    for (auto const& v : rowids)
+        m_rowids[v] = container;
+
+    evict();
+}
+
+
+void listing_cache::changed(int const& operation, long long const& rowid)
+{
+    if (m_entries.empty())
+        return;
+
+    // rows leaving a container
+    if (operation == SQLITE_DELETE || operation == SQLITE_UPDATE)
+    {
+        auto found = m_rowids.find(rowid);
+        if (found != m_rowids.end())
+            invalidate(std::string {found->second});
+        else
+            // its old container is unknown and gone by the next read
+            invalidate_partial();
+    }
+
+    // rows entering one, resolved before the next read
+    if (operation == SQLITE_INSERT || operation == SQLITE_UPDATE)
+        m_pending.push_back(rowid);
+}
+
+
+std::vector<long long> listing_cache::take_pending()
+{
+    std::vector<long long> result {};
+    result.swap(m_pending);
+    return result;
+}
+
+
+void listing_cache::invalidate(std::string const& container)
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        auto const current = it++;
+        if (current->container == container)
+            erase(current);
+    }
+}
+
+
+void listing_cache::clear()
+{
+    m_index.clear();
+    m_entries.clear();
+    m_rowids.clear();
+    m_pending.clear();
+    m_bytes = 0;
+}
+
+
+bool listing_cache::empty() const { return m_entries.empty(); }
+
+
+void listing_cache::budget(size_t const& bytes)
+{
+    m_budget = bytes;
+    evict();
+}
+
+
+size_t listing_cache::budget() const { return m_budget; }
+
+
+size_t listing_cache::bytes() const { return m_bytes; }
+
+
+size_t listing_cache::hits() const { return m_hits; }
+
+
+size_t listing_cache::misses() const { return m_misses; }
+
+
+size_t listing_cache::evictions() const { return m_evictions; }
+
+
+void listing_cache::erase(std::list<entry>::iterator const& found)
+{
+    bool shared = false;
+
+    for (auto const& v : m_entries)
+        if (&v != &(*found) && v.container == found->container)
+            shared = true;
+
+    // rowids stay mapped while another listing of the container remains
+    if (!shared)
+        for (auto const& v : found->rowids)
+            m_rowids.erase(v);
+
+    m_bytes -= found->bytes;
+    m_index.erase(found->key);
+    m_entries.erase(found);
+}
+
+
+void listing_cache::invalidate_partial()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        auto const current = it++;
+        if (!current->complete)
+            erase(current);
+    }
+}
+
+
+void listing_cache::evict()
+{
+    while (m_bytes > m_budget && !m_entries.empty())
+    {
+        erase(std::prev(m_entries.end()));
+        ++m_evictions;
+    }
+}
+
+
+size_t listing_cache::footprint(listing const& value)
+{
+    size_t result = value.capacity() * sizeof(bookmark);
+
+    for (auto const& v : value)
+        result += v.identifier.capacity() + v.container.capacity() +
+                  v.type.capacity() + v.url.capacity() + v.title.capacity() +
+                  v.note.capacity() + v.created.capacity() +
+                  v.modified.capacity();
+
+    return result;
+}
+} // namespace bookmarks
+} // namespace mm
@@ -0,0 +1,103 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include "bookmark.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+// bounded LRU of decoded listings of a single container
+// rows are tracked by rowid, changes reported by the update hook
+// invalidate every listing of the row's container; a partial listing,
+// paged or cut by its limit, does not know every row of its container
+// and is also dropped when an untracked row is deleted or updated
+class listing_cache
+{
+public:
+    using listing = std::vector<bookmark>;
+
+    listing_cache();
+    ~listing_cache();
+
+    listing_cache(listing_cache const&)            = delete;
+    listing_cache& operator=(listing_cache const&) = delete;
+
+    std::shared_ptr<listing const> find(std::string const& key);
+    // complete when value holds every row of container
+    void insert(std::string const&                    key,
+                std::string const&                    container,
+                std::shared_ptr<listing const> const& value,
+                std::vector<long long> const&         rowids,
+                bool const&                           complete);
+
+    // from sqlite3_update_hook, no database access is allowed there
+    void changed(int const& operation, long long const& rowid);
+    // inserted or updated rows whose container is not known yet
+    std::vector<long long> take_pending();
+
+    void invalidate(std::string const& container);
+    void clear();
+    bool empty() const;
+
+    // approximate bytes of cached listings, 0 disables
+    void   budget(size_t const& bytes);
+    size_t budget() const;
+    size_t bytes() const;
+    size_t hits() const;
+    size_t misses() const;
+    size_t evictions() const;
+
+
+private:
+    struct entry
+    {
+        std::string                    key       = {};
+        std::string                    container = {};
+        std::shared_ptr<listing const> value     = {};
+        std::vector<long long>         rowids    = {};
+        size_t                         bytes     = 0;
+        bool                           complete  = false;
+    };
+
+    void erase(std::list<entry>::iterator const& found);
+    void invalidate_partial();
+    void evict();
+
+    static size_t footprint(listing const& value);
+
+    size_t                 m_budget    = 0;
+    size_t                 m_bytes     = 0;
+    size_t                 m_hits      = 0;
+    size_t                 m_misses    = 0;
+    size_t                 m_evictions = 0;
+    std::list<entry>       m_entries   = {};
+    std::vector<long long> m_pending   = {};
+    std::unordered_map<std::string, std::list<entry>::iterator> m_index = {};
+    std::unordered_map<long long, std::string> m_rowids = {};
+};
+} // namespace bookmarks
+} // namespace mm
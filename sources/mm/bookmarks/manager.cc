@@ -19,18 +19,48 @@
 
 #include "manager.hh"
 #include "sql.hh"
+#include "schema.hh"
 #include "utilities.hh"
+#include "transaction.hh"
 #include <mm/sqlite/utilities.hh>
 #include <mm/sqlite/column.hh>
 #include <mm/sqlite/row.hh>
 #include <stdexcept>
 #include <algorithm>
 #include <iostream>
+#include <chrono>
+#include <array>
+#include <functional>
+#include <unordered_set>
 
 namespace mm
 {
 namespace bookmarks
 {
+namespace
+{
+void listing_update_hook(void*         data,
+                         int           operation,
+                         char const*   database,
+                         char const*   table,
+                         sqlite3_int64 rowid)
+{
+    if (std::string {database} != "main" ||
+        std::string {table} != "mm_bookmarks")
+        return;
+
+    static_cast<listing_cache*>(data)->changed(operation, rowid);
+}
+
+
+// containers loaded inside the transaction may be gone
+void containers_rollback_hook(void* data)
+{
+    *static_cast<long long*>(data) = -1;
+}
+} // namespace
+
+
 manager::manager() = default;
 
 
@@ -49,6 +79,14 @@ manager::manager(std::string const& directory, std::string const& filename)
 }
 
 
+manager::manager(std::string const&        directory,
+                 std::string const&        filename,
+                 connection_options const& options)
+{
+    open(directory, filename, options);
+}
+
+
 void manager::open(std::string const& directory)
 {
     open(directory, m_default_filename);
@@ -57,6 +95,16 @@ void manager::open(std::string const& directory)
 
 void manager::open(std::string const& directory, std::string const& filename)
 {
+    open(directory, filename, connection_options {});
+}
+
+
+void manager::open(std::string const&        directory,
+                   std::string const&        filename,
+                   connection_options const& options)
+{
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
     if (opened())
         throw std::runtime_error {"Database already opened."};
 
@@ -68,13 +116,53 @@ void manager::open(std::string const& directory, std::string const& filename)
 #endif
 
     m_filepath = directory + std::string {separator} + filename;
+    m_options  = options;
     m_database.open(m_filepath, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+    m_options.apply(m_database);
+    m_statements.reset(m_database.handle());
     prepare_databases();
+
+    m_listings.clear();
+    sqlite3_update_hook(m_database.handle(), &listing_update_hook, &m_listings);
+    sqlite3_rollback_hook(
+        m_database.handle(), &containers_rollback_hook, &m_containers_version);
+
+    if (m_options.readers > 0)
+    {
+        if (connection_options::effective(m_database).journal_mode != "WAL")
+            throw std::runtime_error {"Reader pool requires WAL journal."};
+
+        m_readers.open(m_filepath,
+                       m_options.readers,
+                       m_options,
+                       m_statements.capacity());
+    }
 }
 
 
 void manager::close()
 {
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    // the file must not be left without its triggers
+    if (m_fast_writes && opened())
+        fast_writes(false);
+
+    m_fast_writes = false;
+    m_containers.clear();
+    m_containers_version = -1;
+
+    if (opened())
+    {
+        sqlite3_update_hook(m_database.handle(), nullptr, nullptr);
+        sqlite3_rollback_hook(m_database.handle(), nullptr, nullptr);
+    }
+    m_listings.clear();
+
+    m_readers.close();
+
+    // statements must be finalized before the connection is closed
+    m_statements.reset(nullptr);
     m_database.close();
     m_filepath.clear();
 }
@@ -83,148 +171,601 @@ void manager::close()
 bool manager::opened() const { return m_database.opened(); }
 
 
+connection_options manager::effective_options()
+{
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    return connection_options::effective(m_database);
+}
+
+
 void manager::prepare_databases()
 {
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
     if (!opened())
         throw std::runtime_error {"Database need to be opened."};
 
+    bool const fresh = sqlite::to_int(m_database.execute(sql::bookmarks::exists)
+                                          .at(0)
+                                          .columns()
+                                          .at("count")
+                                          .value()) == 0;
+
     for (auto const& v : sql::versions::create)
         m_database.execute(v);
 
+    // migrations may rebuild the table, dropping its triggers,
+    // which bookmarks::create puts back
+    if (!fresh)
+        migrate_databases();
+
     for (auto const& v : sql::bookmarks::create)
         m_database.execute(v);
+
+    // created at the latest version
+    if (fresh)
+    {
+        sqlite::row _row {};
+        _row.append("VERSION",
+                    sqlite::column {
+                        std::to_string(sql::migrations::steps.back().first),
+                        "VERSION"});
+        m_database.execute(sql::migrations::update_version, _row);
+    }
+
+    if (ancestry_index())
+        for (auto const& v : sql::ancestry::triggers)
+            m_database.execute(v);
+
+    if (m_fast_writes)
+        for (auto const& v : sql::bookmarks::drop_insert_triggers)
+            m_database.execute(v);
+
+    bool const indexed = sqlite::to_int(m_database.execute(sql::search::exists)
+                                            .at(0)
+                                            .columns()
+                                            .at("count")
+                                            .value()) > 0;
+
+    for (auto const& v : sql::search::create)
+        m_database.execute(v);
+
+    // backfill rows that predate the index
+    if (!indexed)
+        rebuild_search_index();
+}
+
+
+void manager::migrate_databases()
+{
+    std::vector<sqlite::row> const rows =
+        m_database.execute(sql::migrations::version);
+
+    unsigned int const current = static_cast<unsigned int>(sqlite::to_int(
+        rows.at(0).columns().at("version_number").value()));
+
+    for (auto const& step : sql::migrations::steps)
+    {
+        if (step.first <= current)
+            continue;
+
+        // can not be changed inside a transaction, and a rebuilt table
+        // is briefly referenced by nothing
+        bool const foreign_keys =
+            sqlite::to_int(m_database.execute("PRAGMA foreign_keys;")
+                               .at(0)
+                               .columns()
+                               .at("foreign_keys")
+                               .value()) != 0;
+
+        m_database.execute("PRAGMA foreign_keys = OFF;");
+
+        transaction tx {m_database};
+
+        for (auto const& v : step.second)
+            m_database.execute(v);
+
+        sqlite::row _row {};
+        _row.append("VERSION",
+                    sqlite::column {std::to_string(step.first), "VERSION"});
+        m_database.execute(sql::migrations::update_version, _row);
+
+        tx.commit();
+
+        if (foreign_keys)
+            m_database.execute("PRAGMA foreign_keys = ON;");
+    }
+}
+
+
+void manager::rebuild_search_index()
+{
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    m_database.execute(sql::search::rebuild);
+}
+
+
+void manager::ancestry_index(bool const& enable)
+{
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    // triggers are about to change, cached statements may refer to them
+    m_statements.clear();
+
+    transaction tx {m_database};
+
+    if (!enable)
+    {
+        for (auto const& v : sql::ancestry::drop)
+            m_database.execute(v);
+    }
+    else
+    {
+        for (auto const& v : sql::ancestry::create)
+            m_database.execute(v);
+        for (auto const& v : sql::ancestry::triggers)
+            m_database.execute(v);
+        for (auto const& v : sql::ancestry::backfill)
+            m_database.execute(v);
+    }
+
+    tx.commit();
+}
+
+
+bool manager::ancestry_index()
+{
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    return sqlite::to_int(m_database.execute(sql::ancestry::exists)
+                              .at(0)
+                              .columns()
+                              .at("count")
+                              .value()) > 0;
+}
+
+
+bool manager::is_descendant(std::string const& identifier,
+                            std::string const& ancestor)
+{
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    std::string const& sql = ancestry_index()
+                                 ? sql::ancestry::contains
+                                 : sql::ancestry::contains_recursive;
+
+    reader_pool::lease connection = reader();
+
+    std::shared_ptr<statement> stmt = connection.statements().acquire(sql);
+
+    stmt->bind_text(stmt->parameter_index("DESCENDANT"), identifier);
+    stmt->bind_text(stmt->parameter_index("ANCESTOR"), ancestor);
+
+    bool const result =
+        stmt->step() && sqlite3_column_int64(stmt->handle(), 0) > 0;
+
+    stmt->reset();
+
+    return result;
 }
 
 
 void manager::vacuum_databases()
 {
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
     if (!opened())
         throw std::runtime_error {"Database need to be opened."};
 
+    m_statements.clear();
+
+    // rowids are INTEGER PRIMARY KEY since schema v2,
+    // VACUUM keeps them and so the search index stays valid
     m_database.execute(sql::sqlite::vacuum);
 }
 
 
-void manager::insert_bookmarks(std::vector<bookmark> const& bookmarks)
+batch_report manager::insert_bookmarks(std::vector<bookmark> const& bookmarks)
 {
+    statistics_recorder::scope measured {m_stats, operation_type::INSERT};
+
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
     if (!opened())
         throw std::runtime_error {"Database need to be opened."};
 
-    sqlite::row _row {};
+    auto const started = std::chrono::steady_clock::now();
+
+    batch_report report {};
 
-    std::string sql {};
-    sql += "INSERT INTO mm_bookmarks ";
-    sql += "([container], [type], [url], [title], [note]) VALUES ";
+    if (bookmarks.empty())
+        return report;
+
+    // [container], [type], [url], [title], [note]
+    constexpr static size_t columns = 5;
 
-    for (size_t i = 0; i < bookmarks.size(); ++i)
+    size_t const chunk = chunk_rows(columns);
+
+    static auto _sql = [](size_t const& rows)
     {
-        bookmark bm = bookmarks.at(i);
+        std::string sql {};
+        sql += "INSERT INTO mm_bookmarks ";
+        sql += "([container], [type], [url], [title], [note]) VALUES ";
 
-        if (bm.container.empty())
-            bm.container = sql::bookmarks::helpers::defaults::container;
+        for (size_t i = 0; i < rows; ++i)
+        {
+            std::string const p = std::to_string(i);
 
-        if (bm.type != sql::bookmarks::helpers::type::container &&
-            bm.type != sql::bookmarks::helpers::type::url)
-            throw std::runtime_error {"Invalid bookmark type."};
+            sql += (i > 0) ? ", " : "";
+            sql += "(:CONTAINER" + p + ", :TYPE" + p + ", :URL" + p +
+                   ", :TITLE" + p + ", :NOTE" + p + ")";
+        }
 
-        sqlite::row tmp_row = bm.to_row(true, std::to_string(i));
+        sql += ";";
+        return sql;
+    };
 
-        for (auto r : tmp_row.columns())
-            _row.append(r.second.parameter(), r.second);
+    std::string const chunk_sql = _sql(chunk);
 
-        std::string _sql {};
+    if (m_fast_writes)
+        load_containers(false);
 
-        _sql += "(";
-        _sql += ":" + tmp_row.columns().at("container").parameter() + ", ";
-        _sql += ":" + tmp_row.columns().at("type").parameter() + ", ";
-        _sql += ":" + tmp_row.columns().at("url").parameter() + ", ";
-        _sql += ":" + tmp_row.columns().at("title").parameter() + ", ";
-        _sql += ":" + tmp_row.columns().at("note").parameter() + "";
-        _sql += ")";
-        _sql += ((i + 1) < bookmarks.size()) ? ", " : "";
+    transaction tx {m_database};
 
-        sql += _sql;
+    try
+    {
+        for (size_t begin = 0; begin < bookmarks.size(); begin += chunk)
+        {
+            size_t const rows = std::min(chunk, bookmarks.size() - begin);
+
+            std::shared_ptr<statement> stmt =
+                m_statements.acquire((rows == chunk) ? chunk_sql : _sql(rows));
+
+            for (size_t i = 0; i < rows; ++i)
+            {
+                bookmark const& bm = bookmarks.at(begin + i);
+
+                if (bm.type != sql::bookmarks::helpers::type::container &&
+                    bm.type != sql::bookmarks::helpers::type::url)
+                    throw std::runtime_error {"Invalid bookmark type."};
+
+                if (m_fast_writes && !bm.container.empty() &&
+                    bm.container !=
+                        sql::bookmarks::helpers::defaults::container &&
+                    !container_exists(bm.container))
+                    throw std::runtime_error {"[container] does not exists"};
+
+                // parameters are numbered in order of appearance
+                int const index = static_cast<int>(i * columns);
+
+                stmt->bind(
+                    index + 1,
+                    sqlite::column {
+                        bm.container.empty()
+                            ? sql::bookmarks::helpers::defaults::container
+                            : bm.container,
+                        sqlite::data_type::TEXT});
+                stmt->bind(index + 2,
+                           sqlite::column {bm.type, sqlite::data_type::TEXT});
+                stmt->bind(index + 3,
+                           sqlite::column {bm.url, sqlite::data_type::TEXT});
+                stmt->bind(index + 4,
+                           sqlite::column {bm.title, sqlite::data_type::TEXT});
+                stmt->bind(index + 5,
+                           sqlite::column {bm.note, sqlite::data_type::TEXT});
+            }
+
+            stmt->step();
+            stmt->reset();
+
+            report.rows += rows;
+            report.chunks += 1;
+        }
+    }
+    catch (...)
+    {
+        // containers loaded since the savepoint may be rolled back with it
+        m_containers_version = -1;
+        throw;
     }
 
-    sql += ";";
+    tx.commit();
+
+    report.statements = report.chunks;
+    report.seconds    = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - started)
+                         .count();
 
-    m_database.execute(sql, _row);
+    measured.rows_in = report.rows;
+
+    return report;
 }
 
 
-void manager::update_bookmarks(std::vector<bookmark> const& bookmarks)
+batch_report manager::update_bookmarks(std::vector<bookmark> const& bookmarks)
 {
+    statistics_recorder::scope measured {m_stats, operation_type::UPDATE};
+
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
     if (!opened())
         throw std::runtime_error {"Database need to be opened."};
 
+    auto const started = std::chrono::steady_clock::now();
+
+    batch_report report {};
+
     if (bookmarks.empty())
-        return;
+        return report;
 
-    for (auto const& v : bookmarks)
-    {
-        sqlite::row              _row {};
-        std::vector<std::string> tmps {};
+    // changed columns of a bookmark form its shape,
+    // each shape has a single statement reused for the whole batch
+    constexpr static auto const& columns = schema::updatable;
 
+    static auto _sql = [](size_t const& shape)
+    {
         std::string sql = "UPDATE mm_bookmarks SET ";
+        bool        any = false;
 
-        static auto _add =
-            [&](std::string const&       name,
-                std::string const&       param,
-                std::string const&       value,
-                sqlite::data_type const& type = sqlite::data_type::TEXT)
+        for (size_t i = 0; i < columns.size(); ++i)
         {
-            if (value.empty())
-                return;
-            tmps.push_back("[" + name + "] = :" + param);
-            _row.append(name, sqlite::column {value, type, param});
-        };
-
-        _add("container", "NEWCONTAINER", v.container);
-        _add("url", "NEWURL", v.url);
-        _add("title", "NEWTITLE", v.title);
-        _add("note", "NEWNOTE", v.note);
-
-        if (tmps.empty())
-            continue;
+            if ((shape & (size_t {1} << i)) == 0)
+                continue;
 
-        for (size_t i = 0; i < tmps.size(); ++i)
-            sql += ((i > 0) ? ", " : "") + tmps.at(i);
+            std::string const name = schema::fields[columns.at(i)].name;
+
+            sql += (any ? ", " : "");
+            sql += "[" + name + "] = :" + form_parameter(name, "NEW");
+            any = true;
+        }
 
         sql += " WHERE [identifier] == :OLDIDENTIFIER;";
-        _row.append("OLDIDENTIFIER",
-                    sqlite::column {v.identifier, "OLDIDENTIFIER"});
+        return sql;
+    };
+
+    std::array<std::shared_ptr<statement>, (size_t {1} << columns.size())>
+        statements {};
+
+    transaction tx {m_database};
+
+    for (auto const& v : bookmarks)
+    {
+        size_t shape = 0;
+
+        for (size_t i = 0; i < columns.size(); ++i)
+            if (!(v.*(schema::fields[columns.at(i)].member)).empty())
+                shape |= (size_t {1} << i);
+
+        if (shape == 0)
+            continue;
+
+        std::shared_ptr<statement>& stmt = statements.at(shape);
+
+        if (!stmt)
+        {
+            stmt = m_statements.acquire(_sql(shape));
+            report.statements += 1;
+        }
+
+        // parameters are numbered in order of appearance
+        int index = 0;
+
+        for (size_t i = 0; i < columns.size(); ++i)
+            if ((shape & (size_t {1} << i)) != 0)
+                stmt->bind(++index,
+                           sqlite::column {
+                               v.*(schema::fields[columns.at(i)].member),
+                               schema::fields[columns.at(i)].type});
+
+        stmt->bind(++index,
+                   sqlite::column {v.identifier, sqlite::data_type::TEXT});
 
-        m_database.execute(sql, _row);
+        stmt->step();
+        stmt->reset();
+
+        report.rows += 1;
     }
+
+    tx.commit();
+
+    report.chunks  = (report.rows > 0) ? 1 : 0;
+    report.seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - started)
+                         .count();
+
+    measured.rows_in = report.rows;
+
+    return report;
 }
 
 
-void manager::delete_bookmarks(std::vector<std::string> const& identifiers)
+batch_report manager::delete_bookmarks(
+    std::vector<std::string> const& identifiers)
 {
+    statistics_recorder::scope measured {m_stats, operation_type::DELETE};
+
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
     if (!opened())
         throw std::runtime_error {"Database need to be opened."};
 
+    auto const started = std::chrono::steady_clock::now();
+
+    batch_report report {};
+
     if (identifiers.empty())
-        return;
+        return report;
+
+    size_t const chunk = chunk_rows(1);
+
+    static auto _sql = [](size_t const& rows)
+    {
+        return "DELETE FROM mm_bookmarks WHERE [identifier] IN " +
+               parameter_list("identifier", rows) + ";";
+    };
 
-    comparison comp {similarity_type::EQUAL, "identifier", identifiers.at(0)};
+    std::string const chunk_sql = _sql(chunk);
 
-    for (size_t i = 1; i < identifiers.size(); ++i)
+    transaction tx {m_database};
+
+    for (size_t begin = 0; begin < identifiers.size(); begin += chunk)
     {
-        comp.append(logical_type::OR,
-                    comparison {similarity_type::EQUAL,
-                                "identifier",
-                                identifiers.at(i)});
+        size_t const rows = std::min(chunk, identifiers.size() - begin);
+
+        std::shared_ptr<statement> stmt =
+            m_statements.acquire((rows == chunk) ? chunk_sql : _sql(rows));
+
+        for (size_t i = 0; i < rows; ++i)
+            stmt->bind(static_cast<int>(i + 1),
+                       sqlite::column {identifiers.at(begin + i),
+                                       sqlite::data_type::TEXT});
+
+        stmt->step();
+        stmt->reset();
+
+        report.rows +=
+            static_cast<size_t>(sqlite3_changes(m_database.handle()));
+        report.chunks += 1;
     }
 
-    std::pair<std::string, sqlite::row> comp_data = comp.statement_and_row();
+    tx.commit();
 
-    std::string sql = {};
+    if (m_fast_writes)
+        for (auto const& v : identifiers)
+            m_containers.erase(v);
+
+    report.statements = report.chunks;
+    report.seconds    = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - started)
+                         .count();
+
+    measured.rows_in = report.rows;
+
+    return report;
+}
+
+
+batch_report manager::move_bookmarks(
+    std::vector<std::string> const& identifiers,
+    std::string const&              container)
+{
+    statistics_recorder::scope measured {m_stats, operation_type::MOVE};
+
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    auto const started = std::chrono::steady_clock::now();
 
-    sql += "DELETE FROM mm_bookmarks WHERE ";
-    sql += comp_data.first + ";";
+    batch_report report {};
 
-    m_database.execute(sql, comp_data.second);
+    if (identifiers.empty())
+        return report;
+
+    sqlite::row target {};
+    target.append("IDENTIFIER",
+                  sqlite::column {container, sqlite::data_type::TEXT,
+                                  "IDENTIFIER"});
+
+    if (container != "0" &&
+        sqlite::to_int(execute(m_statements,
+                               sql::ancestry::container_exists,
+                               target)
+                           .at(0)
+                           .columns()
+                           .at("count")
+                           .value()) == 0)
+        throw std::runtime_error {"[container] does not exists"};
+
+    bool const indexed = ancestry_index();
+
+    // nothing may be moved into itself or below itself
+    sqlite::row descendant {};
+    descendant.append("DESCENDANT",
+                      sqlite::column {container, sqlite::data_type::TEXT,
+                                      "DESCENDANT"});
+
+    std::unordered_set<std::string> above {};
+
+    for (auto const& v : execute(m_statements,
+                                 indexed ? sql::ancestry::ancestors
+                                         : sql::ancestry::ancestors_recursive,
+                                 descendant))
+        above.insert(v.columns().at("identifier").value());
+
+    for (auto const& v : identifiers)
+        if (above.count(v) > 0)
+            throw std::runtime_error {"[container] is invalid"};
+
+    size_t const chunk = chunk_rows(1, 1);
+
+    static auto _sql = [](size_t const& rows)
+    {
+        return "UPDATE mm_bookmarks SET [container] = :NEWCONTAINER"
+               " WHERE [identifier] IN " +
+               parameter_list("identifier", rows) + ";";
+    };
+
+    std::string const chunk_sql = _sql(chunk);
+
+    transaction tx {m_database};
+
+    // the per row recursive check is redundant after the check above,
+    // the flag is cleared before commit, or by the rollback
+    if (!indexed)
+        execute(m_statements, sql::bookmarks::begin_checked_moves);
+
+    for (size_t begin = 0; begin < identifiers.size(); begin += chunk)
+    {
+        size_t const rows = std::min(chunk, identifiers.size() - begin);
+
+        std::shared_ptr<statement> stmt =
+            m_statements.acquire((rows == chunk) ? chunk_sql : _sql(rows));
+
+        stmt->bind(1, sqlite::column {container, sqlite::data_type::TEXT});
+
+        for (size_t i = 0; i < rows; ++i)
+            stmt->bind(static_cast<int>(i + 2),
+                       sqlite::column {identifiers.at(begin + i),
+                                       sqlite::data_type::TEXT});
+
+        stmt->step();
+        stmt->reset();
+
+        report.rows +=
+            static_cast<size_t>(sqlite3_changes(m_database.handle()));
+        report.chunks += 1;
+    }
+
+    if (!indexed)
+        execute(m_statements, sql::bookmarks::end_checked_moves);
+
+    tx.commit();
+
+    report.statements = report.chunks;
+    report.seconds    = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - started)
+                         .count();
+
+    measured.rows_in = report.rows;
+
+    return report;
 }
 
 
@@ -234,78 +775,810 @@ std::vector<bookmark> manager::select_bookmarks(
     unsigned int const&                              limit,
     unsigned int const&                              offset)
 {
-    if (!opened())
-        throw std::runtime_error {"Database need to be opened."};
+    std::vector<bookmark> result {};
 
-    std::pair<std::string, sqlite::row> comp = comparison_.statement_and_row();
+    bool const listable =
+        m_listings.budget() > 0 && !comparison_.compound() &&
+        !comparison_.negated() &&
+        comparison_.type() == similarity_type::EQUAL &&
+        comparison_.key() == "container";
 
-    std::string order_by {};
+    // a writer in the middle of a transaction bypasses the cache,
+    // its changes are not visible to every connection yet
+    std::unique_lock<std::recursive_mutex> lock {m_mutex, std::defer_lock};
 
-    for (auto v : order_by_and_asc)
+    if (listable && opened() && lock.try_lock() &&
+        sqlite3_get_autocommit(m_database.handle()) != 0)
     {
-        bookmark::valid_key(v.first);
-        if (!order_by.empty())
-            order_by += ", ";
-        order_by += "[" + v.first + "] " + (v.second ? "ASC" : "DESC");
-    }
+        statistics_recorder::scope measured {m_stats,
+                                             operation_type::SELECT};
 
-    comp.second.append("MLIMIT",
-                       sqlite::column {static_cast<int>(limit), "MLIMIT"});
-    comp.second.append("MOFFSET",
-                       sqlite::column {static_cast<int>(offset), "MOFFSET"});
+        refresh_listings();
 
-    std::string sql = {};
+        std::string key = comparison_.column().value();
+        for (auto const& v : order_by_and_asc)
+            key += "\x1f" + v.first + (v.second ? "+" : "-");
+        key += "\x1f" + std::to_string(limit) + "\x1f" + std::to_string(offset);
 
-    sql += "SELECT * FROM mm_bookmarks";
-    sql += " WHERE " + comp.first;
-    sql += " ORDER BY " + order_by;
-    sql += " LIMIT :MLIMIT OFFSET :MOFFSET;";
+        std::shared_ptr<listing_cache::listing const> found =
+            m_listings.find(key);
+
+        if (found)
+        {
+            measured.rows_out = found->size();
+            return *found;
+        }
 
-    std::vector<bookmark>    result {};
-    std::vector<sqlite::row> rows = m_database.execute(sql, comp.second);
+        reader_pool::lease connection = reader();
+
+        std::shared_ptr<statement> stmt =
+            prepare_select(connection.statements(),
+                           comparison_,
+                           order_by_and_asc,
+                           limit,
+                           offset);
+
+        int key_index = -1;
+        for (int i = 0; i < stmt->column_count(); ++i)
+            if (stmt->column_name(i) == "key")
+                key_index = i;
+
+        std::vector<long long> rowids {};
+
+        visit(*stmt,
+              [&](bookmark const& bm)
+              {
+                  result.push_back(bm);
+                  rowids.push_back(
+                      sqlite3_column_int64(stmt->handle(), key_index));
+                  return true;
+              });
+
+        m_listings.insert(
+            key,
+            comparison_.column().value(),
+            std::make_shared<listing_cache::listing const>(result),
+            rowids,
+            offset == 0 && result.size() < limit);
+
+        measured.rows_out = result.size();
+
+        return result;
+    }
 
-    for (auto const& v : rows)
-        result.push_back(bookmark {v});
+    select_bookmarks(comparison_,
+                     order_by_and_asc,
+                     limit,
+                     offset,
+                     [&](bookmark const& bm)
+                     {
+                         result.push_back(bm);
+                         return true;
+                     });
 
     return result;
 }
 
 
-size_t manager::count_bookmarks(comparison const& comparison_)
+size_t manager::select_bookmarks(
+    comparison const&                                comparison_,
+    std::vector<std::pair<std::string, bool>> const& order_by_and_asc,
+    unsigned int const&                              limit,
+    unsigned int const&                              offset,
+    std::function<bool(bookmark const&)> const&      visitor)
 {
+    statistics_recorder::scope measured {m_stats, operation_type::SELECT};
+
     if (!opened())
         throw std::runtime_error {"Database need to be opened."};
 
-    std::pair<std::string, sqlite::row> comp = comparison_.statement_and_row();
+    reader_pool::lease connection = reader();
 
-    std::string sql = {};
-
-    sql += "SELECT COUNT(*) FROM mm_bookmarks";
-    sql += " WHERE " + comp.first;
+    std::shared_ptr<statement> stmt = prepare_select(connection.statements(),
+                                                     comparison_,
+                                                     order_by_and_asc,
+                                                     limit,
+                                                     offset);
 
-    std::vector<sqlite::row> rows = m_database.execute(sql, comp.second);
+    measured.rows_out = visit(*stmt, visitor);
 
-    return static_cast<size_t>(
-        sqlite::to_int(rows.at(0).columns().at("COUNT(*)").value()));
+    return measured.rows_out;
 }
 
 
-void manager::import_from(source_type const& type, std::string const& path)
+bookmark_batch manager::select_bookmarks_batch(
+    comparison const&                                comparison_,
+    std::vector<std::pair<std::string, bool>> const& order_by_and_asc,
+    unsigned int const&                              limit,
+    unsigned int const&                              offset)
 {
+    statistics_recorder::scope measured {m_stats, operation_type::SELECT};
+
     if (!opened())
         throw std::runtime_error {"Database need to be opened."};
-    if (path.empty())
-        throw std::runtime_error {"External source path is required."};
 
-    std::vector<std::string> cleanup;
-    std::string              detach;
-    std::string              attach;
-    std::vector<std::string> preparation;
-    std::vector<std::string> process;
+    reader_pool::lease connection = reader();
 
-    switch (type)
+    std::shared_ptr<statement> stmt = prepare_select(connection.statements(),
+                                                     comparison_,
+                                                     order_by_and_asc,
+                                                     limit,
+                                                     offset);
+
+    sqlite3_stmt* handle = stmt->handle();
+
+    std::array<int, schema::fields.size()> columns {};
+    columns.fill(-1);
+
+    for (int i = 0; i < stmt->column_count(); ++i)
     {
-    case source_type::MMBOOKMARKS:
+        size_t const f = schema::find(stmt->column_name(i));
+        if (f != schema::npos)
+            columns.at(f) = i;
+    }
+
+    bookmark_batch result {};
+
+    // offsets grow with the rows, arenas grow geometrically,
+    // a batch costs a handful of allocations per column
+    if (limit > 0)
+        result.reserve(std::min<size_t>(limit, 4096));
+
+    try
+    {
+        while (stmt->step())
+        {
+            for (size_t f = 0; f < columns.size(); ++f)
+            {
+                bookmark_batch::column& c = result.m_columns.at(f);
+
+                if (columns.at(f) >= 0)
+                {
+                    if (schema::fields[f].type == sqlite::data_type::INTEGER &&
+                        sqlite3_column_type(handle, columns.at(f)) ==
+                            SQLITE_INTEGER)
+                        format_timestamp(
+                            sqlite3_column_int64(handle, columns.at(f)),
+                            c.arena);
+                    else
+                    {
+                        unsigned char const* text =
+                            sqlite3_column_text(handle, columns.at(f));
+                        int const bytes =
+                            sqlite3_column_bytes(handle, columns.at(f));
+
+                        if (text != nullptr)
+                            c.arena.append(
+                                reinterpret_cast<char const*>(text),
+                                static_cast<size_t>(bytes));
+                    }
+                }
+
+                c.offsets.push_back(c.arena.size());
+            }
+        }
+    }
+    catch (...)
+    {
+        stmt->reset();
+        throw;
+    }
+
+    stmt->reset();
+
+    measured.rows_out = result.size();
+
+    return result;
+}
+
+
+std::shared_ptr<statement> manager::prepare_select(
+    statement_cache&                                 statements,
+    comparison const&                                comparison_,
+    std::vector<std::pair<std::string, bool>> const& order_by_and_asc,
+    unsigned int const&                              limit,
+    unsigned int const&                              offset)
+{
+    std::vector<sqlite::column> const values = comparison_.values();
+
+    std::string const sql =
+        select_sql(comparison_.compile(), values.size(), order_by_and_asc);
+
+    if (logging())
+        std::cerr << "| SQL : " << sql << std::endl;
+
+    check_plan(statements, sql);
+
+    std::shared_ptr<statement> stmt = statements.acquire(sql);
+
+    bind_select(*stmt, values, limit, offset);
+
+    return stmt;
+}
+
+
+std::string manager::select_sql(
+    std::string const&                               where,
+    size_t const&                                    slots,
+    std::vector<std::pair<std::string, bool>> const& order_by_and_asc)
+{
+    std::string order_by {};
+
+    for (auto v : order_by_and_asc)
+    {
+        bookmark::valid_key(v.first);
+        if (!order_by.empty())
+            order_by += ", ";
+        order_by += "[" + v.first + "] " + (v.second ? "ASC" : "DESC");
+    }
+
+    std::string sql = {};
+
+    sql += "SELECT * FROM mm_bookmarks";
+    sql += " WHERE " + where;
+    sql += " ORDER BY " + order_by;
+    sql += " LIMIT ?" + std::to_string(slots + 1);
+    sql += " OFFSET ?" + std::to_string(slots + 2) + ";";
+
+    return sql;
+}
+
+
+void manager::bind_select(statement&                         stmt,
+                          std::vector<sqlite::column> const& values,
+                          unsigned int const&                limit,
+                          unsigned int const&                offset)
+{
+    int index = 0;
+
+    for (auto const& v : values)
+        stmt.bind(++index, v);
+
+    sqlite3_stmt* handle = stmt.handle();
+
+    // bound directly, an empty column would bind NULL
+    if (sqlite3_bind_int64(handle, ++index, limit) != SQLITE_OK ||
+        sqlite3_bind_int64(handle, ++index, offset) != SQLITE_OK)
+        throw std::runtime_error {sqlite3_errmsg(sqlite3_db_handle(handle))};
+}
+
+
+query manager::prepare_query(
+    comparison const&                                shape,
+    std::vector<std::pair<std::string, bool>> const& order_by_and_asc)
+{
+    query result {};
+
+    result.m_shape = shape;
+    result.m_slots = shape.values().size();
+    result.m_sql   = statement_cache::normalize(
+        select_sql(shape.compile(), result.m_slots, order_by_and_asc));
+
+    return result;
+}
+
+
+std::vector<bookmark> manager::select_bookmarks(query const&        query_,
+                                                comparison const&   values,
+                                                unsigned int const& limit,
+                                                unsigned int const& offset)
+{
+    std::vector<bookmark> result {};
+
+    select_bookmarks(query_,
+                     values,
+                     limit,
+                     offset,
+                     [&](bookmark const& bm)
+                     {
+                         result.push_back(bm);
+                         return true;
+                     });
+
+    return result;
+}
+
+
+size_t manager::select_bookmarks(
+    query const&                                query_,
+    comparison const&                           values,
+    unsigned int const&                         limit,
+    unsigned int const&                         offset,
+    std::function<bool(bookmark const&)> const& visitor)
+{
+    statistics_recorder::scope measured {m_stats, operation_type::SELECT};
+
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    if (query_.m_sql.empty() || !query_.m_shape.same_shape(values))
+        throw std::runtime_error {"Comparison does not match the query."};
+
+    if (logging())
+        std::cerr << "| SQL : " << query_.m_sql << std::endl;
+
+    reader_pool::lease connection = reader();
+
+    check_plan(connection.statements(), query_.m_sql);
+
+    std::shared_ptr<statement> stmt =
+        connection.statements().acquire(query_.m_sql, true);
+
+    bind_select(*stmt, values.values(), limit, offset);
+
+    measured.rows_out = visit(*stmt, visitor);
+
+    return measured.rows_out;
+}
+
+
+page manager::select_bookmarks_page(
+    comparison const&                    comparison_,
+    std::pair<std::string, bool> const&  order_by_and_asc,
+    unsigned int const&                  limit,
+    std::string const&                   cursor_)
+{
+    statistics_recorder::scope measured {m_stats, operation_type::PAGE};
+
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    if (limit == 0)
+        throw std::runtime_error {"Page limit can not be zero."};
+
+    std::string const& key       = order_by_and_asc.first;
+    bool const&        ascending = order_by_and_asc.second;
+
+    bookmark::valid_key(key);
+
+    cursor after {};
+
+    if (!cursor_.empty())
+    {
+        after = cursor {cursor_};
+        if (after.key != key || after.ascending != ascending)
+            throw std::runtime_error {"Cursor does not match ordering."};
+    }
+
+    // the filter keeps its shape across calls, so do the seek and limit,
+    // whose slots follow the filter's values
+    std::vector<sqlite::column> const values = comparison_.values();
+
+    std::string const value_slot = "?" + std::to_string(values.size() + 1);
+    std::string const identifier_slot =
+        "?" + std::to_string(values.size() + 2);
+    std::string const limit_slot = "?" + std::to_string(values.size() + 3);
+
+    std::string const column = "[" + key + "]";
+    std::string const order  = ascending ? " ASC" : " DESC";
+    std::string const beyond = ascending ? " > " : " < ";
+
+    // NULLs sort first, the seek predicate has to step over them explicitly
+    std::string seek {};
+
+    if (cursor_.empty())
+        seek = "";
+    else if (key == "identifier")
+        seek = "[identifier]" + beyond + identifier_slot;
+    else if (after.null_value && ascending)
+        seek = "(" + column + " IS NULL AND [identifier] > " +
+               identifier_slot + ") OR " + column + " IS NOT NULL";
+    else if (after.null_value)
+        seek = column + " IS NULL AND [identifier] < " + identifier_slot;
+    else if (ascending)
+        seek = "(" + column + ", [identifier]) > (" + value_slot + ", " +
+               identifier_slot + ")";
+    else
+        seek = "(" + column + ", [identifier]) < (" + value_slot + ", " +
+               identifier_slot + ") OR " + column + " IS NULL";
+
+    std::string sql = {};
+
+    sql += "SELECT * FROM mm_bookmarks";
+    sql += " WHERE (" + comparison_.compile() + ")";
+    sql += seek.empty() ? "" : " AND (" + seek + ")";
+    sql += " ORDER BY " + column + order;
+    sql += (key == "identifier") ? "" : ", [identifier]" + order;
+    sql += " LIMIT " + limit_slot + ";";
+
+    if (logging())
+        std::cerr << "| SQL : " << sql << std::endl;
+
+    reader_pool::lease connection = reader();
+
+    check_plan(connection.statements(), sql);
+
+    std::shared_ptr<statement> stmt = connection.statements().acquire(sql);
+
+    int index = 0;
+
+    for (auto const& v : values)
+        stmt->bind(++index, v);
+
+    // an empty sort key is still a value, not NULL
+    if (!seek.empty())
+    {
+        if (bookmark::timestamp_key(key) && !after.null_value)
+            stmt->bind(index + 1,
+                       sqlite::column {std::to_string(parse_timestamp(
+                                           after.value)),
+                                       sqlite::data_type::INTEGER});
+        else
+            stmt->bind_text(index + 1, after.value);
+        stmt->bind_text(index + 2, after.identifier);
+    }
+
+    // one extra row tells whether another page exists
+    if (sqlite3_bind_int64(stmt->handle(),
+                           index + 3,
+                           static_cast<sqlite3_int64>(limit) + 1) != SQLITE_OK)
+        throw std::runtime_error {
+            sqlite3_errmsg(sqlite3_db_handle(stmt->handle()))};
+
+    page result {};
+
+    cursor last {};
+    last.key       = key;
+    last.ascending = ascending;
+
+    int key_index        = -1;
+    int identifier_index = -1;
+
+    for (int i = 0; i < stmt->column_count(); ++i)
+    {
+        if (stmt->column_name(i) == key)
+            key_index = i;
+        if (stmt->column_name(i) == "identifier")
+            identifier_index = i;
+    }
+
+    while (stmt->step())
+    {
+        if (result.bookmarks.size() == limit)
+        {
+            result.cursor = last.token();
+            break;
+        }
+
+        result.bookmarks.push_back(bookmark {stmt->row()});
+
+        last.null_value =
+            (sqlite3_column_type(stmt->handle(), key_index) == SQLITE_NULL);
+        last.value      = stmt->column_value(key_index);
+        last.identifier = stmt->column_value(identifier_index);
+    }
+
+    stmt->reset();
+
+    measured.rows_out = result.bookmarks.size();
+
+    return result;
+}
+
+
+size_t manager::count_bookmarks(comparison const& comparison_)
+{
+    statistics_recorder::scope measured {m_stats, operation_type::COUNT};
+
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    std::vector<sqlite::column> const values = comparison_.values();
+
+    // same text as explain() reports
+    std::string const sql =
+        "SELECT COUNT(*) FROM mm_bookmarks WHERE " + comparison_.compile() +
+        ";";
+
+    if (logging())
+        std::cerr << "| SQL : " << sql << std::endl;
+
+    reader_pool::lease connection = reader();
+
+    check_plan(connection.statements(), sql);
+
+    std::shared_ptr<statement> stmt = connection.statements().acquire(sql);
+
+    int index = 0;
+
+    for (auto const& v : values)
+        stmt->bind(++index, v);
+
+    size_t result = 0;
+
+    if (stmt->step())
+        result = static_cast<size_t>(sqlite3_column_int64(stmt->handle(), 0));
+
+    stmt->reset();
+
+    return result;
+}
+
+
+std::vector<bookmark> manager::select_bookmarks_between(
+    timestamp_type const&                        type,
+    std::chrono::system_clock::time_point const& from,
+    std::chrono::system_clock::time_point const& to,
+    unsigned int const&                          limit)
+{
+    statistics_recorder::scope measured {m_stats, operation_type::BETWEEN};
+
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    std::string const key = enum_string(type);
+
+    // rowid breaks ties, it is part of every index entry
+    std::string const sql = "SELECT * FROM mm_bookmarks WHERE [" + key +
+                            "] >= :MFROM AND [" + key + "] < :MTO ORDER BY [" +
+                            key + "] DESC, [key] DESC LIMIT :MLIMIT;";
+
+    static auto _milliseconds =
+        [](std::chrono::system_clock::time_point const& point)
+    {
+        return std::to_string(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                point.time_since_epoch())
+                .count());
+    };
+
+    sqlite::row _row {};
+    _row.append("MFROM",
+                sqlite::column {_milliseconds(from),
+                                sqlite::data_type::INTEGER,
+                                "MFROM"});
+    _row.append("MTO",
+                sqlite::column {_milliseconds(to),
+                                sqlite::data_type::INTEGER,
+                                "MTO"});
+    _row.append("MLIMIT",
+                sqlite::column {std::to_string(limit),
+                                sqlite::data_type::INTEGER,
+                                "MLIMIT"});
+
+    reader_pool::lease connection = reader();
+
+    std::vector<bookmark> result {};
+
+    if (logging())
+        std::cerr << "| SQL : " << sql << std::endl;
+
+    check_plan(connection.statements(), sql);
+
+    std::shared_ptr<statement> stmt = connection.statements().acquire(sql);
+
+    stmt->bind(_row);
+
+    visit(*stmt,
+          [&](bookmark const& bm)
+          {
+              result.push_back(bm);
+              return true;
+          });
+
+    measured.rows_out = result.size();
+
+    return result;
+}
+
+
+tree manager::fetch_subtree(std::string const&  identifier,
+                           unsigned int const& max_depth)
+{
+    statistics_recorder::scope measured {m_stats, operation_type::SUBTREE};
+
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    if (logging())
+        std::cerr << "| SQL : " << sql::bookmarks::subtree << std::endl;
+
+    reader_pool::lease connection = reader();
+
+    std::shared_ptr<statement> stmt =
+        connection.statements().acquire(sql::bookmarks::subtree);
+
+    stmt->bind_text(stmt->parameter_index("IDENTIFIER"), identifier);
+    stmt->bind(stmt->parameter_index("MDEPTH"),
+               sqlite::column {std::to_string(max_depth),
+                               sqlite::data_type::INTEGER,
+                               "MDEPTH"});
+
+    sqlite3_stmt* handle = stmt->handle();
+
+    std::array<int, schema::fields.size()> columns {};
+    columns.fill(-1);
+
+    int node_index   = -1;
+    int parent_index = -1;
+    int depth_index  = -1;
+
+    for (int i = 0; i < stmt->column_count(); ++i)
+    {
+        std::string const name = stmt->column_name(i);
+
+        size_t const f = schema::find(name);
+
+        if (f != schema::npos)
+            columns.at(f) = i;
+        else if (name == "mm_node")
+            node_index = i;
+        else if (name == "mm_parent")
+            parent_index = i;
+        else if (name == "mm_depth")
+            depth_index = i;
+    }
+
+    tree result {};
+
+    // rowid of each node and of its parent, resolved to indices afterwards
+    std::vector<std::pair<sqlite3_int64, size_t>> rowids {};
+    std::vector<sqlite3_int64>                    parents {};
+
+    try
+    {
+        while (stmt->step())
+        {
+            tree::node n {};
+
+            n.depth = static_cast<unsigned int>(
+                sqlite3_column_int(handle, depth_index));
+
+            for (size_t f = 0; f < columns.size(); ++f)
+            {
+                if (columns.at(f) < 0)
+                    continue;
+
+                if (schema::fields[f].type == sqlite::data_type::INTEGER &&
+                    sqlite3_column_type(handle, columns.at(f)) ==
+                        SQLITE_INTEGER)
+                {
+                    size_t const begin = result.m_arena.size();
+                    format_timestamp(
+                        sqlite3_column_int64(handle, columns.at(f)),
+                        result.m_arena);
+                    n.fields.at(f) = {begin, result.m_arena.size() - begin};
+                    continue;
+                }
+
+                unsigned char const* text =
+                    sqlite3_column_text(handle, columns.at(f));
+                size_t const bytes = static_cast<size_t>(
+                    sqlite3_column_bytes(handle, columns.at(f)));
+
+                n.fields.at(f) = {result.m_arena.size(), bytes};
+
+                if (text != nullptr)
+                    result.m_arena.append(reinterpret_cast<char const*>(text),
+                                          bytes);
+            }
+
+            rowids.emplace_back(sqlite3_column_int64(handle, node_index),
+                                result.m_nodes.size());
+            parents.push_back(
+                (sqlite3_column_type(handle, parent_index) == SQLITE_NULL)
+                    ? -1
+                    : sqlite3_column_int64(handle, parent_index));
+
+            result.m_nodes.push_back(n);
+        }
+    }
+    catch (...)
+    {
+        stmt->reset();
+        throw;
+    }
+
+    stmt->reset();
+
+    std::sort(rowids.begin(), rowids.end());
+
+    // rows are ordered by depth then sibling order, so appending keeps it
+    std::vector<size_t> last_child(result.m_nodes.size(), tree::npos);
+
+    for (size_t i = 0; i < result.m_nodes.size(); ++i)
+    {
+        auto const found = std::lower_bound(
+            rowids.cbegin(),
+            rowids.cend(),
+            std::pair<sqlite3_int64, size_t> {parents.at(i), 0});
+
+        if (found == rowids.cend() || found->first != parents.at(i))
+            continue;
+
+        size_t const parent = found->second;
+
+        result.m_nodes.at(i).parent = parent;
+
+        if (last_child.at(parent) == tree::npos)
+            result.m_nodes.at(parent).first_child = i;
+        else
+            result.m_nodes.at(last_child.at(parent)).next_sibling = i;
+
+        last_child.at(parent) = i;
+    }
+
+    measured.rows_out = result.size();
+
+    return result;
+}
+
+
+std::vector<search_result> manager::search_bookmarks(
+    std::string const&  query,
+    unsigned int const& limit)
+{
+    statistics_recorder::scope measured {m_stats, operation_type::SEARCH};
+
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    if (query.empty())
+        throw std::runtime_error {"Search query is required."};
+
+    if (logging())
+        std::cerr << "| SQL : " << sql::search::query << std::endl;
+
+    reader_pool::lease connection = reader();
+
+    std::shared_ptr<statement> stmt =
+        connection.statements().acquire(sql::search::query);
+
+    stmt->bind_text(stmt->parameter_index("QUERY"), query);
+    stmt->bind(stmt->parameter_index("MLIMIT"),
+               sqlite::column {std::to_string(limit),
+                               sqlite::data_type::INTEGER,
+                               "MLIMIT"});
+
+    int rank_index    = -1;
+    int snippet_index = -1;
+
+    for (int i = 0; i < stmt->column_count(); ++i)
+    {
+        if (stmt->column_name(i) == "mm_rank")
+            rank_index = i;
+        if (stmt->column_name(i) == "mm_snippet")
+            snippet_index = i;
+    }
+
+    std::vector<search_result> result {};
+
+    visit(*stmt,
+          [&](bookmark const& bm)
+          {
+              result.push_back(search_result {
+                  bm,
+                  sqlite3_column_double(stmt->handle(), rank_index),
+                  stmt->column_value(snippet_index)});
+              return true;
+          });
+
+    measured.rows_out = result.size();
+
+    return result;
+}
+
+
+void manager::import_from(source_type const& type, std::string const& path)
+{
+    statistics_recorder::scope measured {m_stats, operation_type::IMPORT};
+
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+    if (path.empty())
+        throw std::runtime_error {"External source path is required."};
+
+    std::vector<std::string> cleanup;
+    std::string              detach;
+    std::string              attach;
+    std::vector<std::string> preparation;
+    std::vector<std::string> process;
+
+    switch (type)
+    {
+    case source_type::MMBOOKMARKS:
     {
         namespace ns = sql::imports::mm_bookmarks;
         cleanup      = {ns::cleanup.begin(), ns::cleanup.end()};
@@ -387,11 +1660,141 @@ void manager::import_from(source_type const& type, std::string const& path)
     };
 
 
-    _import_cleanup(m_database, cleanup, detach, false);
+    // imports rely on the row triggers
+    bool const fast = m_fast_writes;
+
+    if (fast)
+        fast_writes(false);
+
+    // temporary import triggers rewrite rows before the search index has
+    // seen them, so the index is rebuilt once afterwards instead
+    for (auto const& v : sql::search::drop_triggers)
+        m_database.execute(v);
+
+    try
+    {
+        _import_cleanup(m_database, cleanup, detach, false);
+
+        _import_prepare_and_process(
+            m_database, attach, path, preparation, process);
+
+        _import_cleanup(m_database, cleanup, detach, true);
+    }
+    catch (...)
+    {
+        for (auto const& v : sql::search::create)
+            m_database.execute(v);
+        rebuild_search_index();
+        if (fast)
+            fast_writes(true);
+        throw;
+    }
+
+    for (auto const& v : sql::search::create)
+        m_database.execute(v);
+    rebuild_search_index();
+
+    if (fast)
+        fast_writes(true);
+}
+
+
+void manager::fast_writes(bool const& enable)
+{
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    m_statements.clear();
+
+    transaction tx {m_database};
+
+    // only the dropped triggers are restored, the rest of the schema,
+    // such as triggers replaced by the ancestry index, is left as it is
+    if (enable)
+        for (auto const& v : sql::bookmarks::drop_insert_triggers)
+            m_database.execute(v);
+    else
+        for (auto const& v : sql::bookmarks::insert_triggers)
+            m_database.execute(v);
+
+    tx.commit();
 
-    _import_prepare_and_process(m_database, attach, path, preparation, process);
+    m_fast_writes = enable;
+    m_containers.clear();
+    m_containers_version = -1;
+}
+
+
+bool manager::fast_writes() const { return m_fast_writes; }
+
+
+bool manager::container_exists(std::string const& identifier)
+{
+    // -1 after a rollback, the loaded set can not be trusted
+    if (m_containers_version != -1 &&
+        m_containers.find(identifier) != m_containers.end())
+        return true;
+
+    // possibly inserted since the last load
+    load_containers(true);
+
+    return m_containers.find(identifier) != m_containers.end();
+}
+
+
+void manager::load_containers(bool const& force)
+{
+    // data_version changes with commits of other connections only
+    long long const version =
+        std::stoll(m_database.execute("PRAGMA data_version;")
+                       .at(0)
+                       .columns()
+                       .at("data_version")
+                       .value());
+
+    if (!force && version == m_containers_version)
+        return;
+
+    m_containers.clear();
 
-    _import_cleanup(m_database, cleanup, detach, true);
+    for (auto const& v : execute(m_statements, sql::bookmarks::containers))
+        m_containers.insert(v.columns().at("identifier").value());
+
+    m_containers_version = version;
+}
+
+
+void manager::atomically(std::function<void()> const& work)
+{
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    transaction tx {m_database};
+
+    try
+    {
+        work();
+    }
+    catch (...)
+    {
+        // a savepoint rolls back without the rollback hook
+        m_containers_version = -1;
+        throw;
+    }
+
+    tx.commit();
+}
+
+
+bool manager::in_transaction()
+{
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    return opened() && sqlite3_get_autocommit(m_database.handle()) == 0;
 }
 
 
@@ -399,5 +1802,398 @@ void manager::logging(bool const& enable) { m_database.logging(enable); }
 
 
 bool manager::logging() const { return m_database.logging(); }
+
+
+void manager::statement_cache_capacity(size_t const& capacity)
+{
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    m_statements.capacity(capacity);
+}
+
+
+size_t manager::statement_cache_capacity() const
+{
+    return m_statements.capacity();
+}
+
+
+void manager::listing_cache_budget(size_t const& bytes)
+{
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    m_listings.budget(bytes);
+}
+
+
+size_t manager::listing_cache_budget() const { return m_listings.budget(); }
+
+
+size_t manager::listing_cache_hits()
+{
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    return m_listings.hits();
+}
+
+
+size_t manager::listing_cache_misses()
+{
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    return m_listings.misses();
+}
+
+
+size_t manager::listing_cache_evictions()
+{
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    return m_listings.evictions();
+}
+
+
+statistics manager::stats()
+{
+    statistics result {};
+
+    for (size_t i = 1; i < statistics_recorder::operations; ++i)
+        result.operations.push_back(
+            m_stats.snapshot(static_cast<operation_type>(i)));
+
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    auto _status = [&](int const& operation)
+    {
+        int current = 0;
+        int highest = 0;
+
+        if (sqlite3_db_status(
+                m_database.handle(), operation, &current, &highest, 0) !=
+            SQLITE_OK)
+            current = 0;
+
+        return current + m_readers.status(operation);
+    };
+
+    if (opened())
+    {
+        result.cache_hits      = _status(SQLITE_DBSTATUS_CACHE_HIT);
+        result.cache_misses    = _status(SQLITE_DBSTATUS_CACHE_MISS);
+        result.cache_writes    = _status(SQLITE_DBSTATUS_CACHE_WRITE);
+        result.cache_used      = _status(SQLITE_DBSTATUS_CACHE_USED);
+        result.statements_used = _status(SQLITE_DBSTATUS_STMT_USED);
+        result.schema_used     = _status(SQLITE_DBSTATUS_SCHEMA_USED);
+    }
+
+    static auto _global = [](int const& operation)
+    {
+        sqlite3_int64 current = 0;
+        sqlite3_int64 highest = 0;
+
+        if (sqlite3_status64(operation, &current, &highest, 0) != SQLITE_OK)
+            current = 0;
+
+        return current;
+    };
+
+    result.memory_used        = _global(SQLITE_STATUS_MEMORY_USED);
+    result.pagecache_used     = _global(SQLITE_STATUS_PAGECACHE_USED);
+    result.pagecache_overflow = _global(SQLITE_STATUS_PAGECACHE_OVERFLOW);
+
+    result.statement_cache_hits    = m_statements.hits();
+    result.statement_cache_misses  = m_statements.misses();
+    result.listing_cache_hits      = m_listings.hits();
+    result.listing_cache_misses    = m_listings.misses();
+    result.listing_cache_evictions = m_listings.evictions();
+
+    return result;
+}
+
+
+void manager::reset_stats() { m_stats.reset(); }
+
+
+void manager::listing_cache_shared(bool const& enable)
+{
+    std::lock_guard<std::recursive_mutex> lock {m_mutex};
+
+    m_listings_shared  = enable;
+    m_listings_version = -1;
+}
+
+
+bool manager::listing_cache_shared() const { return m_listings_shared; }
+
+
+void manager::refresh_listings()
+{
+    if (m_listings_shared)
+    {
+        long long const version =
+            std::stoll(m_database.execute("PRAGMA data_version;")
+                           .at(0)
+                           .columns()
+                           .at("data_version")
+                           .value());
+
+        if (version != m_listings_version)
+            m_listings.clear();
+
+        m_listings_version = version;
+    }
+
+    std::vector<long long> const pending = m_listings.take_pending();
+
+    if (pending.empty() || m_listings.empty())
+        return;
+
+    size_t const chunk = chunk_rows(1);
+
+    // a bulk change is cheaper to forget than to resolve
+    if (pending.size() > chunk)
+    {
+        m_listings.clear();
+        return;
+    }
+
+    std::string const sql =
+        "SELECT DISTINCT [container] FROM mm_bookmarks WHERE [key] IN " +
+        parameter_list("key", pending.size()) + ";";
+
+    std::shared_ptr<statement> stmt = m_statements.acquire(sql);
+
+    for (size_t i = 0; i < pending.size(); ++i)
+        stmt->bind(static_cast<int>(i + 1),
+                   sqlite::column {std::to_string(pending.at(i)),
+                                   sqlite::data_type::INTEGER});
+
+    std::vector<std::string> containers {};
+
+    while (stmt->step())
+        containers.push_back(stmt->column_value(0));
+
+    stmt->reset();
+
+    for (auto const& v : containers)
+        m_listings.invalidate(v);
+}
+
+
+void manager::chunk_size(size_t const& rows)
+{
+    if (rows == 0)
+        throw std::runtime_error {"Chunk size can not be zero."};
+    m_chunk_size = rows;
+}
+
+
+size_t manager::chunk_size() const { return m_chunk_size; }
+
+
+size_t manager::statement_cache_hits() const { return m_statements.hits(); }
+
+
+size_t manager::statement_cache_misses() const
+{
+    return m_statements.misses();
+}
+
+
+size_t manager::chunk_rows(size_t const& parameters_per_row,
+                           size_t const& fixed_parameters) const
+{
+    // bound parameters of a single statement are limited
+    size_t const limit = static_cast<size_t>(sqlite3_limit(
+        m_database.handle(), SQLITE_LIMIT_VARIABLE_NUMBER, -1));
+
+    size_t const rows =
+        (limit > fixed_parameters ? limit - fixed_parameters : 0) /
+        std::max<size_t>(parameters_per_row, 1);
+
+    return std::max<size_t>(std::min(m_chunk_size, rows), 1);
+}
+
+
+size_t manager::visit(statement&                                  stmt,
+                      std::function<bool(bookmark const&)> const& visitor)
+{
+    // column positions are resolved once, rows are decoded in place
+    std::vector<std::pair<int, field const*>> columns {};
+
+    for (int i = 0; i < stmt.column_count(); ++i)
+    {
+        size_t const index = schema::find(stmt.column_name(i));
+        if (index != schema::npos)
+            columns.emplace_back(i, &schema::fields[index]);
+    }
+
+    size_t   count = 0;
+    bookmark bm {};
+
+    try
+    {
+        while (stmt.step())
+        {
+            for (auto const& v : columns)
+            {
+                // timestamps are formatted on the way out
+                if (v.second->type == sqlite::data_type::INTEGER &&
+                    sqlite3_column_type(stmt.handle(), v.first) ==
+                        SQLITE_INTEGER)
+                {
+                    (bm.*(v.second->member)).clear();
+                    format_timestamp(
+                        sqlite3_column_int64(stmt.handle(), v.first),
+                        bm.*(v.second->member));
+                    continue;
+                }
+
+                unsigned char const* text =
+                    sqlite3_column_text(stmt.handle(), v.first);
+                int const bytes = sqlite3_column_bytes(stmt.handle(), v.first);
+
+                if (text == nullptr)
+                    (bm.*(v.second->member)).clear();
+                else
+                    (bm.*(v.second->member))
+                        .assign(reinterpret_cast<char const*>(text),
+                                static_cast<size_t>(bytes));
+            }
+
+            ++count;
+
+            if (!visitor(bm))
+                break;
+        }
+    }
+    catch (...)
+    {
+        stmt.reset();
+        throw;
+    }
+
+    stmt.reset();
+
+    return count;
+}
+
+
+reader_pool::lease manager::reader()
+{
+    if (m_readers.opened())
+    {
+        // a thread inside its own transaction reads its own writes
+        std::unique_lock<std::recursive_mutex> lock {m_mutex,
+                                                     std::try_to_lock};
+
+        if (!lock.owns_lock() ||
+            sqlite3_get_autocommit(m_database.handle()) != 0)
+            return m_readers.acquire();
+
+        return reader_pool::lease {m_database, m_statements, std::move(lock)};
+    }
+
+    return reader_pool::lease {
+        m_database,
+        m_statements,
+        std::unique_lock<std::recursive_mutex> {m_mutex}};
+}
+
+
+query_plan manager::explain(
+    comparison const&                                comparison_,
+    std::vector<std::pair<std::string, bool>> const& order_by_and_asc)
+{
+    if (!opened())
+        throw std::runtime_error {"Database need to be opened."};
+
+    std::string const where = comparison_.compile();
+
+    std::string const sql =
+        order_by_and_asc.empty()
+            ? "SELECT COUNT(*) FROM mm_bookmarks WHERE " + where + ";"
+            : select_sql(where, comparison_.values().size(), order_by_and_asc);
+
+    reader_pool::lease connection = reader();
+
+    return explain(connection.statements(), sql);
+}
+
+
+void manager::scan_warnings(bool const& enable)
+{
+    std::lock_guard<std::mutex> lock {m_plans_mutex};
+    m_scan_warnings = enable;
+    m_plans.clear();
+}
+
+
+bool manager::scan_warnings() const { return m_scan_warnings; }
+
+
+query_plan manager::explain(statement_cache& statements, std::string const& sql)
+{
+    query_plan result {};
+    result.sql = sql;
+
+    // parameters are left unbound, the plan does not depend on them
+    std::shared_ptr<statement> stmt =
+        statements.acquire("EXPLAIN QUERY PLAN " + sql);
+
+    try
+    {
+        while (stmt->step())
+            result.append(sqlite3_column_int(stmt->handle(), 0),
+                          sqlite3_column_int(stmt->handle(), 1),
+                          stmt->column_value(3));
+    }
+    catch (...)
+    {
+        stmt->reset();
+        throw;
+    }
+
+    stmt->reset();
+
+    return result;
+}
+
+
+void manager::check_plan(statement_cache& statements, std::string const& sql)
+{
+    if (!m_scan_warnings)
+        return;
+
+    // each statement is looked at once
+    {
+        std::lock_guard<std::mutex> lock {m_plans_mutex};
+        if (!m_plans.insert(statement_cache::normalize(sql)).second)
+            return;
+    }
+
+    for (auto const& v : explain(statements, sql).steps)
+        if (v.full_scan("mm_bookmarks"))
+            std::cerr << "| SCAN : " << v.detail << " : " << sql << std::endl;
+}
+
+
+std::vector<sqlite::row> manager::execute(statement_cache&   statements,
+                                          std::string const& sql,
+                                          sqlite::row const& row_)
+{
+    if (logging())
+        std::cerr << "| SQL : " << sql << std::endl;
+
+    std::shared_ptr<statement> stmt = statements.acquire(sql);
+
+    stmt->bind(row_);
+
+    std::vector<sqlite::row> result = stmt->rows();
+
+    stmt->reset();
+
+    return result;
+}
 } // namespace bookmarks
 } // namespace mm
@@ -21,8 +21,25 @@
 
 #include <string>
 #include <vector>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <unordered_set>
+#include <chrono>
 #include "bookmark.hh"
 #include "comparison.hh"
+#include "report.hh"
+#include "cursor.hh"
+#include "query.hh"
+#include "query_plan.hh"
+#include "statistics.hh"
+#include "search_result.hh"
+#include "tree.hh"
+#include "bookmark_batch.hh"
+#include "statement_cache.hh"
+#include "listing_cache.hh"
+#include "connection_options.hh"
+#include "reader_pool.hh"
 #include <mm/sqlite/database.hh>
 
 namespace mm
@@ -37,36 +54,214 @@ public:
 
     manager(std::string const& directory);
     manager(std::string const& directory, std::string const& filename);
+    manager(std::string const&        directory,
+            std::string const&        filename,
+            connection_options const& options);
 
     void open(std::string const& directory);
     void open(std::string const& directory, std::string const& filename);
+    void open(std::string const&        directory,
+              std::string const&        filename,
+              connection_options const& options);
     void close();
     bool opened() const;
 
+    // values reported back by the connection
+    connection_options effective_options();
+
     void prepare_databases();
     void vacuum_databases();
+    void rebuild_search_index();
 
-    void insert_bookmarks(std::vector<bookmark> const& bookmarks);
-    void update_bookmarks(std::vector<bookmark> const& bookmarks);
-    void delete_bookmarks(std::vector<std::string> const& identifiers);
+    batch_report insert_bookmarks(std::vector<bookmark> const& bookmarks);
+    batch_report update_bookmarks(std::vector<bookmark> const& bookmarks);
+    batch_report delete_bookmarks(std::vector<std::string> const& identifiers);
+    // target and cycles are validated once for the whole set
+    batch_report move_bookmarks(std::vector<std::string> const& identifiers,
+                                std::string const&              container);
     std::vector<bookmark> select_bookmarks(
         comparison const&                                comparison_,
         std::vector<std::pair<std::string, bool>> const& order_by_and_asc,
         unsigned int const&                              limit,
         unsigned int const&                              offset);
+    // rows are streamed to visitor as they are stepped, returning false stops
+    size_t select_bookmarks(
+        comparison const&                                comparison_,
+        std::vector<std::pair<std::string, bool>> const& order_by_and_asc,
+        unsigned int const&                              limit,
+        unsigned int const&                              offset,
+        std::function<bool(bookmark const&)> const&      visitor);
+    // same rows, filled column by column straight from the statement
+    bookmark_batch select_bookmarks_batch(
+        comparison const&                                comparison_,
+        std::vector<std::pair<std::string, bool>> const& order_by_and_asc,
+        unsigned int const&                              limit,
+        unsigned int const&                              offset);
+    // filter shape compiled once, values are taken from later comparisons
+    query prepare_query(
+        comparison const&                                shape,
+        std::vector<std::pair<std::string, bool>> const& order_by_and_asc);
+    std::vector<bookmark> select_bookmarks(query const&        query_,
+                                           comparison const&   values,
+                                           unsigned int const& limit,
+                                           unsigned int const& offset);
+    size_t select_bookmarks(
+        query const&                                query_,
+        comparison const&                           values,
+        unsigned int const&                         limit,
+        unsigned int const&                         offset,
+        std::function<bool(bookmark const&)> const& visitor);
+    // keyset pagination, cost does not depend on page depth
+    page select_bookmarks_page(
+        comparison const&                   comparison_,
+        std::pair<std::string, bool> const& order_by_and_asc,
+        unsigned int const&                 limit,
+        std::string const&                  cursor_ = "");
     size_t count_bookmarks(comparison const& comparison_);
 
+    // [from, to) newest first, a range scan of the timestamp's index
+    std::vector<bookmark> select_bookmarks_between(
+        timestamp_type const&                        type,
+        std::chrono::system_clock::time_point const& from,
+        std::chrono::system_clock::time_point const& to,
+        unsigned int const&                          limit);
+
+    // identifier and everything below it, up to max_depth levels, one query
+    tree fetch_subtree(std::string const&  identifier,
+                       unsigned int const& max_depth);
+
+    // full-text search over title, url and note, best ranked first
+    // query uses FTS5 syntax, see search_query() for plain text
+    std::vector<search_result> search_bookmarks(std::string const&  query,
+                                                unsigned int const& limit);
+
+    // plan of select_bookmarks over comparison_ and order_by_and_asc,
+    // of count_bookmarks when order_by_and_asc is empty
+    query_plan explain(
+        comparison const&                                comparison_,
+        std::vector<std::pair<std::string, bool>> const& order_by_and_asc);
+    // statements whose plan scans mm_bookmarks are written to std::cerr,
+    // every distinct statement is explained once on first use
+    void scan_warnings(bool const& enable);
+    bool scan_warnings() const;
+
+    // counters and latency of every operation since open or reset_stats,
+    // with the page cache status of each connection
+    statistics stats();
+    void       reset_stats();
+
+    // closure table of every ancestor of every bookmark,
+    // container moves are validated by a lookup instead of a recursive walk
+    void ancestry_index(bool const& enable);
+    bool ancestry_index();
+    bool is_descendant(std::string const& identifier,
+                       std::string const& ancestor);
+
     void import_from(source_type const& type, std::string const& path);
 
+    // inserts are validated by the manager against cached containers
+    // instead of per row triggers, which are restored when disabled,
+    // closed or importing; other writers are not validated meanwhile
+    void fast_writes(bool const& enable);
+    bool fast_writes() const;
+
+    // runs work as a single transaction on the writer connection
+    void atomically(std::function<void()> const& work);
+    bool in_transaction();
+
     void logging(bool const& enable);
     bool logging() const;
 
+    // rows per statement of batched writes
+    void   chunk_size(size_t const& rows);
+    size_t chunk_size() const;
+
+    void   statement_cache_capacity(size_t const& capacity);
+    size_t statement_cache_capacity() const;
+    size_t statement_cache_hits() const;
+    size_t statement_cache_misses() const;
+
+    // results of select_bookmarks over a single [container] == value,
+    // served from memory until a row of that container changes
+    void   listing_cache_budget(size_t const& bytes);
+    size_t listing_cache_budget() const;
+    size_t listing_cache_hits();
+    size_t listing_cache_misses();
+    size_t listing_cache_evictions();
+    // checks PRAGMA data_version on each read, for files other
+    // connections write to, whose changes the update hook does not see
+    void listing_cache_shared(bool const& enable);
+    bool listing_cache_shared() const;
+
 
 private:
+    // upgrades schema in place, driven by mm_versions
+    void migrate_databases();
+
+    // known containers, reloaded on a miss or after others' commits
+    bool container_exists(std::string const& identifier);
+    void load_containers(bool const& force);
+
+    // drops listings touched by changes since the last read
+    void refresh_listings();
+
+    std::shared_ptr<statement> prepare_select(
+        statement_cache&                                 statements,
+        comparison const&                                comparison_,
+        std::vector<std::pair<std::string, bool>> const& order_by_and_asc,
+        unsigned int const&                              limit,
+        unsigned int const&                              offset);
+
+    static std::string select_sql(
+        std::string const&                               where,
+        size_t const&                                    slots,
+        std::vector<std::pair<std::string, bool>> const& order_by_and_asc);
+    static void bind_select(statement&                         stmt,
+                            std::vector<sqlite::column> const& values,
+                            unsigned int const&                limit,
+                            unsigned int const&                offset);
+
+    query_plan explain(statement_cache& statements, std::string const& sql);
+    void       check_plan(statement_cache& statements, std::string const& sql);
+
+    size_t chunk_rows(size_t const& parameters_per_row,
+                      size_t const& fixed_parameters = 0) const;
+
+    size_t visit(statement&                                  stmt,
+                 std::function<bool(bookmark const&)> const& visitor);
+
+    // pooled read connection, or the locked writer without a pool
+    reader_pool::lease reader();
+
+    std::vector<sqlite::row> execute(statement_cache&   statements,
+                                     std::string const& sql,
+                                     sqlite::row const& row_ = {});
+
     constexpr static char const* m_default_filename = "mm_bookmarks.db";
 
-    std::string      m_filepath = {};
-    sqlite::database m_database = {};
+    size_t             m_chunk_size = 256;
+    std::string        m_filepath   = {};
+    connection_options m_options    = {};
+    sqlite::database   m_database   = {};
+    statement_cache    m_statements = {};
+    reader_pool        m_readers    = {};
+
+    bool                            m_fast_writes        = false;
+    std::unordered_set<std::string> m_containers         = {};
+    long long                       m_containers_version = -1;
+
+    listing_cache m_listings         = {};
+    bool          m_listings_shared  = false;
+    long long     m_listings_version = -1;
+
+    std::atomic<bool>               m_scan_warnings = {false};
+    std::unordered_set<std::string> m_plans         = {};
+    std::mutex                      m_plans_mutex   = {};
+
+    statistics_recorder m_stats = {};
+
+    // guards the writer connection and its statements
+    std::recursive_mutex m_mutex = {};
 };
 } // namespace bookmarks
 } // namespace mm
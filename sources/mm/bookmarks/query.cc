@@ -0,0 +1,40 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "query.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+query::query() = default;
+
+
+query::~query() = default;
+
+
+comparison const& query::shape() const { return m_shape; }
+
+
+std::string const& query::sql() const { return m_sql; }
+
+
+size_t query::slots() const { return m_slots; }
+} // namespace bookmarks
+} // namespace mm
@@ -0,0 +1,54 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include "comparison.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+// select of a filter shape compiled once by manager::prepare_query
+// later runs look the prepared statement up by its normalized text
+// and only rebind values
+class query
+{
+public:
+    query();
+    ~query();
+
+    comparison const&  shape() const;
+    std::string const& sql() const;
+    // comparison values, limit and offset follow
+    size_t slots() const;
+
+
+private:
+    friend class manager;
+
+    comparison  m_shape = {};
+    std::string m_sql   = {};
+    size_t      m_slots = 0;
+};
+} // namespace bookmarks
+} // namespace mm
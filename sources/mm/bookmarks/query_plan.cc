@@ -0,0 +1,88 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "query_plan.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+bool query_plan::step::full_scan(std::string const& table) const
+{
+    // older sqlite says SCAN TABLE, newer only SCAN
+    for (std::string const prefix : {"SCAN TABLE ", "SCAN "})
+    {
+        if (detail.compare(0, prefix.size(), prefix) != 0)
+            continue;
+
+        std::string const rest = detail.substr(prefix.size());
+
+        if (rest.compare(0, table.size(), table) == 0 &&
+            (rest.size() == table.size() || rest.at(table.size()) == ' '))
+            return true;
+    }
+
+    return false;
+}
+
+
+query_plan::query_plan() = default;
+
+
+query_plan::~query_plan() = default;
+
+
+void query_plan::append(int const&         id,
+                        int const&         parent,
+                        std::string const& detail)
+{
+    step s {};
+
+    s.id     = id;
+    s.parent = parent;
+    s.detail = detail;
+
+    for (auto const& v : steps)
+        if (v.id == parent)
+            s.depth = v.depth + 1;
+
+    steps.push_back(s);
+}
+
+
+bool query_plan::full_scan(std::string const& table) const
+{
+    for (auto const& v : steps)
+        if (v.full_scan(table))
+            return true;
+    return false;
+}
+
+
+std::string query_plan::to_string() const
+{
+    std::string result {};
+
+    for (auto const& v : steps)
+        result += std::string(v.depth * 2, ' ') + "- " + v.detail + "\n";
+
+    return result;
+}
+} // namespace bookmarks
+} // namespace mm
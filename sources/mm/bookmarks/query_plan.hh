@@ -0,0 +1,61 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace mm
+{
+namespace bookmarks
+{
+// EXPLAIN QUERY PLAN of a statement
+// steps come in the order sqlite reports them, which is depth first
+class query_plan
+{
+public:
+    class step
+    {
+    public:
+        int          id     = 0;
+        int          parent = 0;
+        unsigned int depth  = 0;
+        std::string  detail = {};
+
+        // SCAN of the table, through an index or not, visits every row
+        bool full_scan(std::string const& table) const;
+    };
+
+    std::string       sql   = {};
+    std::vector<step> steps = {};
+
+    query_plan();
+    ~query_plan();
+
+    // depth is taken from the parent step
+    void append(int const& id, int const& parent, std::string const& detail);
+
+    bool full_scan(std::string const& table) const;
+
+    // indented like the sqlite3 shell prints it
+    std::string to_string() const;
+};
+} // namespace bookmarks
+} // namespace mm
@@ -0,0 +1,255 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "reader_pool.hh"
+#include <stdexcept>
+#include <utility>
+
+namespace mm
+{
+namespace bookmarks
+{
+reader_pool::lease::lease() = default;
+
+
+reader_pool::lease::~lease() { release(); }
+
+
+reader_pool::lease::lease(lease&& other) noexcept
+    : m_pool {other.m_pool},
+      m_index {other.m_index},
+      m_database {other.m_database},
+      m_statements {other.m_statements},
+      m_lock {std::move(other.m_lock)}
+{
+    other.m_pool       = nullptr;
+    other.m_database   = nullptr;
+    other.m_statements = nullptr;
+}
+
+
+reader_pool::lease& reader_pool::lease::operator=(lease&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    release();
+
+    m_pool       = other.m_pool;
+    m_index      = other.m_index;
+    m_database   = other.m_database;
+    m_statements = other.m_statements;
+    m_lock       = std::move(other.m_lock);
+
+    other.m_pool       = nullptr;
+    other.m_database   = nullptr;
+    other.m_statements = nullptr;
+
+    return *this;
+}
+
+
+reader_pool::lease::lease(sqlite::database&                      database,
+                          statement_cache&                       statements,
+                          std::unique_lock<std::recursive_mutex> lock)
+    : m_database {&database},
+      m_statements {&statements},
+      m_lock {std::move(lock)}
+{
+}
+
+
+sqlite::database& reader_pool::lease::database() const
+{
+    return *m_database;
+}
+
+
+statement_cache& reader_pool::lease::statements() const
+{
+    return *m_statements;
+}
+
+
+void reader_pool::lease::release()
+{
+    if (m_pool != nullptr)
+        m_pool->release(m_index);
+
+    m_pool       = nullptr;
+    m_database   = nullptr;
+    m_statements = nullptr;
+
+    if (m_lock.owns_lock())
+        m_lock.unlock();
+}
+
+
+reader_pool::reader_pool() = default;
+
+
+reader_pool::~reader_pool() { close(); }
+
+
+void reader_pool::open(std::string const&        filepath,
+                       size_t const&             readers,
+                       connection_options const& options,
+                       size_t const&             statement_cache_capacity)
+{
+    std::lock_guard<std::mutex> lock {m_mutex};
+
+    if (!m_readers.empty())
+        throw std::runtime_error {"Reader pool already opened."};
+
+    for (size_t i = 0; i < readers; ++i)
+    {
+        auto r = std::make_unique<reader>();
+
+        // each connection is used by a single thread at a time
+        r->database.open(filepath,
+                         SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX);
+        options.apply(r->database, true);
+        r->statements.reset(r->database.handle());
+        r->statements.capacity(statement_cache_capacity);
+
+        m_readers.push_back(std::move(r));
+        m_free.push_back(i);
+    }
+}
+
+
+void reader_pool::close()
+{
+    std::unique_lock<std::mutex> lock {m_mutex};
+
+    // wait for outstanding leases
+    m_available.wait(lock, [&] { return m_free.size() == m_readers.size(); });
+
+    for (auto& v : m_readers)
+    {
+        v->statements.reset(nullptr);
+        v->database.close();
+    }
+
+    m_readers.clear();
+    m_free.clear();
+}
+
+
+bool reader_pool::opened() const
+{
+    std::lock_guard<std::mutex> lock {m_mutex};
+    return !m_readers.empty();
+}
+
+
+size_t reader_pool::size() const
+{
+    std::lock_guard<std::mutex> lock {m_mutex};
+    return m_readers.size();
+}
+
+
+long long reader_pool::status(int const& operation) const
+{
+    std::lock_guard<std::mutex> lock {m_mutex};
+
+    long long result = 0;
+
+    for (auto const& v : m_readers)
+    {
+        // leased connections are NOMUTEX and in use by their owner, an
+        // idle one can not be leased while m_mutex is held here
+        if (v->depth == 0)
+        {
+            int current = 0;
+            int highest = 0;
+
+            if (sqlite3_db_status(v->database.handle(),
+                                  operation,
+                                  &current,
+                                  &highest,
+                                  0) == SQLITE_OK)
+                v->sampled[operation] = current;
+        }
+
+        auto const found = v->sampled.find(operation);
+        if (found != v->sampled.end())
+            result += found->second;
+    }
+
+    return result;
+}
+
+
+reader_pool::lease reader_pool::acquire()
+{
+    std::unique_lock<std::mutex> lock {m_mutex};
+
+    if (m_readers.empty())
+        throw std::runtime_error {"Reader pool is not opened."};
+
+    std::thread::id const self = std::this_thread::get_id();
+
+    size_t index = m_readers.size();
+
+    for (size_t i = 0; i < m_readers.size(); ++i)
+        if (m_readers.at(i)->depth > 0 && m_readers.at(i)->owner == self)
+            index = i;
+
+    if (index == m_readers.size())
+    {
+        m_available.wait(lock, [&] { return !m_free.empty(); });
+        index = m_free.back();
+        m_free.pop_back();
+        m_readers.at(index)->owner = self;
+    }
+
+    reader& r = *m_readers.at(index);
+    r.depth += 1;
+
+    lease result {};
+    result.m_pool       = this;
+    result.m_index      = index;
+    result.m_database   = &r.database;
+    result.m_statements = &r.statements;
+
+    return result;
+}
+
+
+void reader_pool::release(size_t const& index)
+{
+    {
+        std::lock_guard<std::mutex> lock {m_mutex};
+
+        reader& r = *m_readers.at(index);
+        r.depth -= 1;
+
+        if (r.depth > 0)
+            return;
+
+        r.owner = std::thread::id {};
+        m_free.push_back(index);
+    }
+
+    m_available.notify_all();
+}
+} // namespace bookmarks
+} // namespace mm
@@ -0,0 +1,119 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "statement_cache.hh"
+#include "connection_options.hh"
+#include <mm/sqlite/database.hh>
+
+namespace mm
+{
+namespace bookmarks
+{
+// read-only connections handed out one thread at a time
+// a thread asking again while holding one gets the same connection back
+class reader_pool
+{
+public:
+    class lease
+    {
+    public:
+        lease();
+        ~lease();
+
+        lease(lease&& other) noexcept;
+        lease& operator=(lease&& other) noexcept;
+
+        lease(lease const&)            = delete;
+        lease& operator=(lease const&) = delete;
+
+        // writer connection, kept locked while leased
+        lease(sqlite::database&                      database,
+              statement_cache&                       statements,
+              std::unique_lock<std::recursive_mutex> lock);
+
+        sqlite::database& database() const;
+        statement_cache&  statements() const;
+
+
+    private:
+        friend class reader_pool;
+
+        void release();
+
+        reader_pool*      m_pool       = nullptr;
+        size_t            m_index      = 0;
+        sqlite::database* m_database   = nullptr;
+        statement_cache*  m_statements = nullptr;
+
+        std::unique_lock<std::recursive_mutex> m_lock = {};
+    };
+
+    reader_pool();
+    ~reader_pool();
+
+    reader_pool(reader_pool const&)            = delete;
+    reader_pool& operator=(reader_pool const&) = delete;
+
+    void open(std::string const&        filepath,
+              size_t const&             readers,
+              connection_options const& options,
+              size_t const&             statement_cache_capacity);
+    void close();
+    bool opened() const;
+    size_t size() const;
+
+    // sqlite3_db_status() current values summed over every reader,
+    // leased readers count with their value when last seen idle
+    long long status(int const& operation) const;
+
+    // blocks until a connection is free
+    lease acquire();
+
+
+private:
+    class reader
+    {
+    public:
+        sqlite::database database   = {};
+        statement_cache  statements = {};
+        std::thread::id  owner      = {};
+        size_t           depth      = 0;
+
+        // by status operation, read under m_mutex while depth is 0
+        std::map<int, long long> sampled = {};
+    };
+
+    void release(size_t const& index);
+
+    std::vector<std::unique_ptr<reader>> m_readers   = {};
+    std::vector<size_t>                  m_free      = {};
+    mutable std::mutex                   m_mutex     = {};
+    std::condition_variable              m_available = {};
+};
+} // namespace bookmarks
+} // namespace mm
@@ -0,0 +1,40 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+
+namespace mm
+{
+namespace bookmarks
+{
+// outcome of a batched write
+class batch_report
+{
+public:
+    size_t rows       = 0;
+    size_t chunks     = 0;
+    size_t statements = 0;
+    double seconds    = 0.0;
+
+    double rows_per_second() const;
+};
+} // namespace bookmarks
+} // namespace mm
@@ -0,0 +1,137 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include "bookmark.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+// a column of mm_bookmarks and the bookmark member it maps to
+class field
+{
+public:
+    char const*             name   = nullptr;
+    std::string bookmark::* member = nullptr;
+    // INTEGER columns are epoch milliseconds, exposed as ISO 8601
+    sqlite::data_type type = sqlite::data_type::TEXT;
+    // empty values are stored, otherwise the column default applies
+    bool nullable = false;
+    // can be changed by update_bookmarks
+    bool updatable = false;
+};
+
+
+namespace schema
+{
+constexpr size_t npos = static_cast<size_t>(-1);
+
+// the only list of bookmark fields, indices into it are stable
+constexpr std::array<field, 8> fields = {{
+    {"identifier", &bookmark::identifier, sqlite::data_type::TEXT},
+    {"container", &bookmark::container, sqlite::data_type::TEXT, false, true},
+    {"type", &bookmark::type, sqlite::data_type::TEXT},
+    {"url", &bookmark::url, sqlite::data_type::TEXT, true, true},
+    {"title", &bookmark::title, sqlite::data_type::TEXT, true, true},
+    {"note", &bookmark::note, sqlite::data_type::TEXT, true, true},
+    {"created", &bookmark::created, sqlite::data_type::INTEGER},
+    {"modified", &bookmark::modified, sqlite::data_type::INTEGER},
+}};
+
+
+// second character and length tell every name apart
+constexpr size_t slot(std::string_view const& name)
+{
+    return (static_cast<unsigned char>(name[1]) + name.size() * 5) % 16;
+}
+
+
+constexpr std::array<size_t, 16> make_slots()
+{
+    std::array<size_t, 16> result {};
+
+    for (auto& v : result)
+        v = npos;
+
+    for (size_t i = 0; i < fields.size(); ++i)
+        result[slot(fields[i].name)] = i;
+
+    return result;
+}
+
+
+constexpr std::array<size_t, 16> slots = make_slots();
+
+
+constexpr bool perfect()
+{
+    for (size_t i = 0; i < fields.size(); ++i)
+        if (slots[slot(fields[i].name)] != i)
+            return false;
+    return true;
+}
+
+
+static_assert(perfect(), "Field names collide, the hash needs changing.");
+
+
+// index in fields or npos, a hash and a single compare
+constexpr size_t find(std::string_view const& name)
+{
+    if (name.size() < 2)
+        return npos;
+
+    size_t const index = slots[slot(name)];
+
+    return (index != npos && name == fields[index].name) ? index : npos;
+}
+
+
+constexpr size_t count_updatable()
+{
+    size_t result = 0;
+    for (auto const& v : fields)
+        result += v.updatable ? 1 : 0;
+    return result;
+}
+
+
+constexpr std::array<size_t, count_updatable()> make_updatable()
+{
+    std::array<size_t, count_updatable()> result {};
+
+    size_t next = 0;
+    for (size_t i = 0; i < fields.size(); ++i)
+        if (fields[i].updatable)
+            result[next++] = i;
+
+    return result;
+}
+
+
+// indices of the fields update_bookmarks can change
+constexpr std::array<size_t, count_updatable()> updatable = make_updatable();
+} // namespace schema
+} // namespace bookmarks
+} // namespace mm
@@ -0,0 +1,41 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+#include "bookmark.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+class search_result
+{
+public:
+    bookmark item = {};
+
+    // bm25, lower is better
+    double rank = 0.0;
+
+    // matched text with hits wrapped in [ ]
+    std::string snippet = {};
+};
+} // namespace bookmarks
+} // namespace mm
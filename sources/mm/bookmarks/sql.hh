@@ -88,13 +88,15 @@ static std::string const container = "0";
 } // namespace helpers
 
 
-static std::vector<std::string> const create = {
-    R"EOF(
+// rowid is the internal key, [identifier] stays the public one
+static std::string const table = R"EOF(
 CREATE TABLE IF NOT EXISTS
 mm_bookmarks
 (
+    [key]
+        INTEGER PRIMARY KEY,
     [identifier]
-        TEXT PRIMARY KEY DEFAULT
+        TEXT UNIQUE NOT NULL DEFAULT
         (
             substr
             (
@@ -112,95 +114,108 @@ mm_bookmarks
         TEXT,
     [note]
         TEXT,
+    -- epoch milliseconds
     [created]
-        TEXT NOT NULL DEFAULT (strftime('%Y-%m-%dT%H:%M:%S+00:00', 'now')),
+        INTEGER NOT NULL DEFAULT
+        (CAST(ROUND((julianday('now') - 2440587.5) * 86400000) AS INTEGER)),
     [modified]
-        TEXT NOT NULL DEFAULT (strftime('%Y-%m-%dT%H:%M:%S+00:00', 'now')),
+        INTEGER NOT NULL DEFAULT
+        (CAST(ROUND((julianday('now') - 2440587.5) * 86400000) AS INTEGER)),
     FOREIGN KEY ([container])
         REFERENCES mm_bookmarks ([identifier])
         ON UPDATE CASCADE
         ON DELETE SET DEFAULT
 );
-    )EOF",
+    )EOF";
 
 
-    // -- TRIGGER
+// children of a container, grouped by type and listed by title
+static std::string const container_type_title_index = R"EOF(
+CREATE INDEX IF NOT EXISTS
+    mm_bookmarks_container_type_title
+ON
+    mm_bookmarks ([container], [type], [title]);
+    )EOF";
 
 
-    R"EOF(
--- [identifier]
-CREATE TRIGGER IF NOT EXISTS
-    mm_bookmarks_identifier_after_insert
-AFTER INSERT ON
-    mm_bookmarks
-WHEN
-(
-    NEW.[identifier] = '0'
-    OR
-    NEW.[identifier] = ''
-    OR
-    NEW.[identifier] IS NULL
-)
-BEGIN
-    SELECT RAISE(ABORT, '[identifier] can not be 0/empty/null');
-END;
-    )EOF",
+// children of a container in creation order
+static std::string const container_created_index = R"EOF(
+CREATE INDEX IF NOT EXISTS
+    mm_bookmarks_container_created
+ON
+    mm_bookmarks ([container], [created]);
+    )EOF";
 
 
-    R"EOF(
--- [identifier]
-CREATE TRIGGER IF NOT EXISTS
-    mm_bookmarks_identifier_after_update
-AFTER UPDATE ON
-    mm_bookmarks
-WHEN
-    NEW.[identifier] != OLD.[identifier]
-BEGIN
-    SELECT RAISE(ROLLBACK, '[identifier] can not be modified');
-END;
-    )EOF",
+// recently added or changed, newest first
+static std::string const created_index = R"EOF(
+CREATE INDEX IF NOT EXISTS
+    mm_bookmarks_created
+ON
+    mm_bookmarks ([created]);
+    )EOF";
 
 
-    R"EOF(
--- [container]
-CREATE TRIGGER IF NOT EXISTS
-    mm_bookmarks_container_after_insert
-AFTER INSERT ON
-    mm_bookmarks
-WHEN
+static std::string const modified_index = R"EOF(
+CREATE INDEX IF NOT EXISTS
+    mm_bookmarks_modified
+ON
+    mm_bookmarks ([modified]);
+    )EOF";
+
+
+// title prefixes and ranges across containers
+static std::string const title_index = R"EOF(
+CREATE INDEX IF NOT EXISTS
+    mm_bookmarks_title
+ON
+    mm_bookmarks ([title]);
+    )EOF";
+
+
+// non empty only inside a move_bookmarks transaction, whose set was
+// validated up front, the per row recursive check is skipped meanwhile
+static std::string const checked_moves_table = R"EOF(
+CREATE TABLE IF NOT EXISTS
+    mm_bookmarks_checked_moves
 (
-    NEW.[container] != '0'
-    AND
-    (
-        NEW.[identifier] == NEW.[container]
-        OR
-        NOT EXISTS
-        (
-            SELECT
-                *
-            FROM
-                mm_bookmarks
-            WHERE
-                mm_bookmarks.[identifier] = NEW.[container]
-                AND
-                mm_bookmarks.[type] = 'CONTAINER'
-        )
-    )
-)
-BEGIN
-    SELECT RAISE(ABORT, '[container] does not exists');
-END;
-    )EOF",
+    [checked]
+        INTEGER NOT NULL
+);
+    )EOF";
 
 
-    R"EOF(
+static std::string const begin_checked_moves =
+    "INSERT INTO mm_bookmarks_checked_moves ([checked]) VALUES (1);";
+
+
+static std::string const end_checked_moves =
+    "DELETE FROM mm_bookmarks_checked_moves;";
+
+
+static std::string const exists = R"EOF(
+SELECT
+    COUNT(*) AS [count]
+FROM
+    sqlite_master
+WHERE
+    [type] = 'table' AND [name] = 'mm_bookmarks';
+    )EOF";
+
+
+// fires only when [container] actually changes
+static std::string const container_after_update_exists = R"EOF(
 -- [container]
 CREATE TRIGGER IF NOT EXISTS
     mm_bookmarks_container_after_update_exists
-AFTER UPDATE ON
+AFTER UPDATE OF
+    [container]
+ON
     mm_bookmarks
 WHEN
 (
+    NEW.[container] != OLD.[container]
+    AND
     NEW.[container] != '0'
     AND
     (
@@ -222,17 +237,30 @@ WHEN
 BEGIN
     SELECT RAISE(ABORT, '[container] does not exists');
 END;
-    )EOF",
+    )EOF";
 
 
-    R"EOF(
+// fires only when [container] actually changes
+static std::string const container_after_update_invalid = R"EOF(
 -- [container]
 CREATE TRIGGER IF NOT EXISTS
     mm_bookmarks_container_after_update_invalid
-AFTER UPDATE ON
+AFTER UPDATE OF
+    [container]
+ON
     mm_bookmarks
 WHEN
 (
+    NEW.[container] != OLD.[container]
+    AND
+    NOT EXISTS
+    (
+        SELECT
+            *
+        FROM
+            mm_bookmarks_checked_moves
+    )
+    AND
     EXISTS
     (
         -- a view of item containing identifier of container
@@ -280,136 +308,940 @@ WHEN
     )
 )
 BEGIN
-    SELECT RAISE(ABORT, '[container] is invalid');
+    SELECT RAISE(ABORT, '[container] is invalid');
+END;
+    )EOF";
+
+
+static std::string const identifier_after_insert = R"EOF(
+-- [identifier]
+CREATE TRIGGER IF NOT EXISTS
+    mm_bookmarks_identifier_after_insert
+AFTER INSERT ON
+    mm_bookmarks
+WHEN
+(
+    NEW.[identifier] = '0'
+    OR
+    NEW.[identifier] = ''
+    OR
+    NEW.[identifier] IS NULL
+)
+BEGIN
+    SELECT RAISE(ABORT, '[identifier] can not be 0/empty/null');
+END;
+    )EOF";
+
+
+static std::string const container_after_insert = R"EOF(
+-- [container]
+CREATE TRIGGER IF NOT EXISTS
+    mm_bookmarks_container_after_insert
+AFTER INSERT ON
+    mm_bookmarks
+WHEN
+(
+    NEW.[container] != '0'
+    AND
+    (
+        NEW.[identifier] == NEW.[container]
+        OR
+        NOT EXISTS
+        (
+            SELECT
+                *
+            FROM
+                mm_bookmarks
+            WHERE
+                mm_bookmarks.[identifier] = NEW.[container]
+                AND
+                mm_bookmarks.[type] = 'CONTAINER'
+        )
+    )
+)
+BEGIN
+    SELECT RAISE(ABORT, '[container] does not exists');
+END;
+    )EOF";
+
+
+static std::string const type_after_insert_invalid = R"EOF(
+-- [type]
+CREATE TRIGGER IF NOT EXISTS
+    mm_bookmarks_type_after_insert_invalid
+AFTER INSERT ON
+    mm_bookmarks
+WHEN
+    NEW.[type] != 'CONTAINER'
+    AND
+    NEW.[type] != 'URL'
+BEGIN
+    SELECT RAISE(ABORT, '[type] is invalid');
+END;
+    )EOF";
+
+
+static std::string const created_after_insert = R"EOF(
+-- [created]
+CREATE TRIGGER IF NOT EXISTS
+    mm_bookmarks_created_after_insert
+AFTER INSERT ON
+    mm_bookmarks
+WHEN
+    NEW.[created] IS NULL OR NEW.[created] = ''
+BEGIN
+    UPDATE
+        mm_bookmarks
+    SET
+        [created]  =
+            CAST(ROUND((julianday('now') - 2440587.5) * 86400000) AS INTEGER)
+    WHERE
+        [key] == NEW.[key];
+END;
+    )EOF";
+
+
+static std::string const modified_after_insert = R"EOF(
+-- [modified]
+CREATE TRIGGER IF NOT EXISTS
+    mm_bookmarks_modified_after_insert
+AFTER INSERT ON
+    mm_bookmarks
+WHEN
+    NEW.[modified] IS NULL OR NEW.[modified] = ''
+BEGIN
+    UPDATE
+        mm_bookmarks
+    SET
+        [modified] =
+            CAST(ROUND((julianday('now') - 2440587.5) * 86400000) AS INTEGER)
+    WHERE
+        [key] == NEW.[key];
+END;
+    )EOF";
+
+
+static std::vector<std::string> const create = {
+    table,
+
+
+    container_type_title_index,
+
+
+    container_created_index,
+
+
+    created_index,
+
+
+    modified_index,
+
+
+    title_index,
+
+
+    checked_moves_table,
+
+
+
+    // -- TRIGGER
+
+
+    identifier_after_insert,
+
+
+    R"EOF(
+-- [identifier]
+CREATE TRIGGER IF NOT EXISTS
+    mm_bookmarks_identifier_after_update
+AFTER UPDATE ON
+    mm_bookmarks
+WHEN
+    NEW.[identifier] != OLD.[identifier]
+BEGIN
+    SELECT RAISE(ROLLBACK, '[identifier] can not be modified');
+END;
+    )EOF",
+
+
+    container_after_insert,
+
+
+    container_after_update_exists,
+
+
+    container_after_update_invalid,
+
+
+    R"EOF(
+-- [container]
+CREATE TRIGGER IF NOT EXISTS
+    mm_bookmarks_container_before_delete
+BEFORE DELETE ON
+    mm_bookmarks
+WHEN
+    EXISTS
+    (
+        SELECT
+            *
+        FROM
+            mm_bookmarks
+        WHERE
+            [container] == OLD.[identifier]
+    )
+BEGIN
+    SELECT RAISE(ROLLBACK, '[container] is not empty');
+END;
+    )EOF",
+
+
+    type_after_insert_invalid,
+
+
+    R"EOF(
+-- [type]
+CREATE TRIGGER IF NOT EXISTS
+    mm_bookmarks_type_after_update
+AFTER UPDATE ON
+    mm_bookmarks
+WHEN
+    NEW.[type] != OLD.[type]
+BEGIN
+    SELECT RAISE(ROLLBACK, '[type] can not be modified');
+END;
+    )EOF",
+
+
+    created_after_insert,
+
+
+    modified_after_insert,
+
+
+    R"EOF(
+-- [modified]
+CREATE TRIGGER IF NOT EXISTS
+    mm_bookmarks_modified_after_update
+AFTER UPDATE ON
+    mm_bookmarks
+BEGIN
+    UPDATE
+        mm_bookmarks
+    SET
+        [modified] =
+            CAST(ROUND((julianday('now') - 2440587.5) * 86400000) AS INTEGER)
+    WHERE
+        [key] == NEW.[key];
+END;
+    )EOF",
+
+
+    // -- reserved bookmarks
+    R"EOF(
+INSERT OR IGNORE INTO
+    mm_bookmarks
+    (
+        [identifier],
+        [container],
+        [type],
+        [title]
+    )
+VALUES
+    ('1', '0', 'CONTAINER', 'MM Bookmarks'),
+    ('2', '1', 'CONTAINER', 'Main Bookmarks'),
+    ('3', '1', 'CONTAINER', 'Other Bookmarks'),
+    ('4', '1', 'CONTAINER', 'Removed Bookmarks');
+    )EOF",
+};
+
+
+// checks and timestamps of inserted rows, replaced by manager::fast_writes()
+static std::vector<std::string> const insert_triggers = {
+    identifier_after_insert,
+    container_after_insert,
+    type_after_insert_invalid,
+    created_after_insert,
+    modified_after_insert,
+};
+
+
+static std::vector<std::string> const drop_insert_triggers = {
+    "DROP TRIGGER IF EXISTS mm_bookmarks_identifier_after_insert;",
+    "DROP TRIGGER IF EXISTS mm_bookmarks_container_after_insert;",
+    "DROP TRIGGER IF EXISTS mm_bookmarks_type_after_insert_invalid;",
+    "DROP TRIGGER IF EXISTS mm_bookmarks_created_after_insert;",
+    "DROP TRIGGER IF EXISTS mm_bookmarks_modified_after_insert;",
+};
+
+
+static std::string const containers = R"EOF(
+SELECT
+    [identifier]
+FROM
+    mm_bookmarks
+WHERE
+    [type] = 'CONTAINER';
+    )EOF";
+
+
+// whole subtree breadth first, each row carries its parent's rowid
+static std::string const subtree = R"EOF(
+WITH RECURSIVE
+    cte_subtree
+    (
+        [node], [identifier], [parent], [depth]
+    )
+AS
+(
+    SELECT
+        mm_bookmarks.rowid, mm_bookmarks.[identifier], NULL, 0
+    FROM
+        mm_bookmarks
+    WHERE
+        mm_bookmarks.[identifier] = :IDENTIFIER
+
+    UNION ALL
+
+    SELECT
+        mm_bookmarks.rowid,
+        mm_bookmarks.[identifier],
+        cte_subtree.[node],
+        cte_subtree.[depth] + 1
+    FROM
+        mm_bookmarks
+    JOIN
+        cte_subtree
+    ON
+        mm_bookmarks.[container] = cte_subtree.[identifier]
+    WHERE
+        cte_subtree.[depth] < :MDEPTH
+)
+SELECT
+    mm_bookmarks.*,
+    cte_subtree.[node] AS [mm_node],
+    cte_subtree.[parent] AS [mm_parent],
+    cte_subtree.[depth] AS [mm_depth]
+FROM
+    cte_subtree
+JOIN
+    mm_bookmarks
+ON
+    mm_bookmarks.rowid = cte_subtree.[node]
+ORDER BY
+    cte_subtree.[depth],
+    mm_bookmarks.[type],
+    mm_bookmarks.[title],
+    mm_bookmarks.[identifier];
+    )EOF";
+} // namespace bookmarks
+
+
+namespace migrations
+{
+static std::string const version = R"EOF(
+SELECT
+    [version_number]
+FROM
+    mm_versions
+WHERE
+    [table_name] = 'mm_bookmarks';
+    )EOF";
+
+
+static std::string const update_version = R"EOF(
+UPDATE
+    mm_versions
+SET
+    [version_number] = :VERSION,
+    [modified] = (strftime('%Y-%m-%dT%H:%M:%S+00:00', 'now'))
+WHERE
+    [table_name] = 'mm_bookmarks';
+    )EOF";
+
+
+// applied in order to databases below each version
+static std::vector<std::pair<unsigned int, std::vector<std::string>>> const
+    steps = {
+        {
+            2,
+            {
+                bookmarks::container_type_title_index,
+                bookmarks::container_created_index,
+            },
+        },
+        {
+            3,
+            {
+                "DROP TRIGGER IF EXISTS "
+                "mm_bookmarks_container_after_update_exists;",
+                "DROP TRIGGER IF EXISTS "
+                "mm_bookmarks_container_after_update_invalid;",
+                bookmarks::container_after_update_exists,
+                bookmarks::container_after_update_invalid,
+            },
+        },
+        {
+            // schema v2, INTEGER PRIMARY KEY, rowids are kept as keys
+            // triggers are dropped along, bookmarks::create restores them
+            4,
+            {
+                "ALTER TABLE mm_bookmarks RENAME TO mm_bookmarks_v1;",
+                bookmarks::table,
+                R"EOF(
+INSERT INTO
+    mm_bookmarks
+    (
+        [key],
+        [identifier],
+        [container],
+        [type],
+        [url],
+        [title],
+        [note],
+        [created],
+        [modified]
+    )
+SELECT
+    rowid,
+    [identifier],
+    [container],
+    [type],
+    [url],
+    [title],
+    [note],
+    [created],
+    [modified]
+FROM
+    mm_bookmarks_v1;
+                )EOF",
+                "DROP TABLE mm_bookmarks_v1;",
+                bookmarks::container_type_title_index,
+                bookmarks::container_created_index,
+            },
+        },
+        {
+            // [created] and [modified] as INTEGER epoch milliseconds
+            5,
+            {
+                "ALTER TABLE mm_bookmarks RENAME TO mm_bookmarks_v2;",
+                bookmarks::table,
+                R"EOF(
+INSERT INTO
+    mm_bookmarks
+    (
+        [key],
+        [identifier],
+        [container],
+        [type],
+        [url],
+        [title],
+        [note],
+        [created],
+        [modified]
+    )
+SELECT
+    [key],
+    [identifier],
+    [container],
+    [type],
+    [url],
+    [title],
+    [note],
+    CASE typeof([created])
+        WHEN 'text' THEN
+            COALESCE
+            (
+                CAST(ROUND((julianday([created]) - 2440587.5) * 86400000)
+                     AS INTEGER),
+                CAST(ROUND((julianday('now') - 2440587.5) * 86400000)
+                     AS INTEGER)
+            )
+        ELSE [created]
+    END,
+    CASE typeof([modified])
+        WHEN 'text' THEN
+            COALESCE
+            (
+                CAST(ROUND((julianday([modified]) - 2440587.5) * 86400000)
+                     AS INTEGER),
+                CAST(ROUND((julianday('now') - 2440587.5) * 86400000)
+                     AS INTEGER)
+            )
+        ELSE [modified]
+    END
+FROM
+    mm_bookmarks_v2;
+                )EOF",
+                "DROP TABLE mm_bookmarks_v2;",
+                bookmarks::container_type_title_index,
+                bookmarks::container_created_index,
+                bookmarks::created_index,
+                bookmarks::modified_index,
+            },
+        },
+        {
+            // set moves skip the recursive check without schema changes
+            6,
+            {
+                bookmarks::checked_moves_table,
+                "DROP TRIGGER IF EXISTS "
+                "mm_bookmarks_container_after_update_invalid;",
+                bookmarks::container_after_update_invalid,
+            },
+        },
+        {
+            // PREFIX over [title] as a range scan
+            7,
+            {
+                bookmarks::title_index,
+            },
+        },
+};
+} // namespace migrations
+
+
+namespace ancestry
+{
+static std::string const exists = R"EOF(
+SELECT
+    COUNT(*) AS [count]
+FROM
+    sqlite_master
+WHERE
+    [type] = 'table' AND [name] = 'mm_bookmarks_ancestry';
+    )EOF";
+
+
+// closure table, every bookmark is its own ancestor at depth 0
+static std::vector<std::string> const create = {
+    R"EOF(
+CREATE TABLE IF NOT EXISTS
+mm_bookmarks_ancestry
+(
+    [ancestor]
+        TEXT NOT NULL,
+    [descendant]
+        TEXT NOT NULL,
+    [depth]
+        INTEGER NOT NULL,
+    PRIMARY KEY ([ancestor], [descendant])
+)
+WITHOUT ROWID;
+    )EOF",
+
+
+    R"EOF(
+CREATE INDEX IF NOT EXISTS
+    mm_bookmarks_ancestry_descendant
+ON
+    mm_bookmarks_ancestry ([descendant], [depth]);
+    )EOF",
+};
+
+
+// kept in sync with mm_bookmarks, recreated along with it
+static std::vector<std::string> const triggers = {
+    R"EOF(
+CREATE TRIGGER IF NOT EXISTS
+    mm_bookmarks_ancestry_after_insert
+AFTER INSERT ON
+    mm_bookmarks
+BEGIN
+    INSERT INTO
+        mm_bookmarks_ancestry
+        ([ancestor], [descendant], [depth])
+    SELECT
+        NEW.[identifier], NEW.[identifier], 0
+    UNION ALL
+    SELECT
+        mm_bookmarks_ancestry.[ancestor],
+        NEW.[identifier],
+        mm_bookmarks_ancestry.[depth] + 1
+    FROM
+        mm_bookmarks_ancestry
+    WHERE
+        mm_bookmarks_ancestry.[descendant] = NEW.[container];
 END;
     )EOF",
 
 
     R"EOF(
--- [container]
+-- detach the moved subtree from its old ancestors, attach to the new ones
 CREATE TRIGGER IF NOT EXISTS
-    mm_bookmarks_container_before_delete
-BEFORE DELETE ON
+    mm_bookmarks_ancestry_after_update
+AFTER UPDATE OF
+    [container]
+ON
     mm_bookmarks
 WHEN
-    EXISTS
-    (
-        SELECT
-            *
-        FROM
-            mm_bookmarks
-        WHERE
-            [container] == OLD.[identifier]
-    )
+    NEW.[container] != OLD.[container]
 BEGIN
-    SELECT RAISE(ROLLBACK, '[container] is not empty');
+    DELETE FROM
+        mm_bookmarks_ancestry
+    WHERE
+        [descendant] IN
+        (
+            SELECT
+                [descendant]
+            FROM
+                mm_bookmarks_ancestry
+            WHERE
+                [ancestor] = NEW.[identifier]
+        )
+        AND
+        [ancestor] IN
+        (
+            SELECT
+                [ancestor]
+            FROM
+                mm_bookmarks_ancestry
+            WHERE
+                [descendant] = NEW.[identifier]
+                AND
+                [ancestor] != NEW.[identifier]
+        );
+
+    INSERT INTO
+        mm_bookmarks_ancestry
+        ([ancestor], [descendant], [depth])
+    SELECT
+        above.[ancestor],
+        below.[descendant],
+        above.[depth] + below.[depth] + 1
+    FROM
+        mm_bookmarks_ancestry AS above
+    JOIN
+        mm_bookmarks_ancestry AS below
+    WHERE
+        above.[descendant] = NEW.[container]
+        AND
+        below.[ancestor] = NEW.[identifier];
 END;
     )EOF",
 
 
     R"EOF(
--- [type]
 CREATE TRIGGER IF NOT EXISTS
-    mm_bookmarks_type_after_insert_invalid
-AFTER INSERT ON
+    mm_bookmarks_ancestry_after_delete
+AFTER DELETE ON
     mm_bookmarks
-WHEN
-    NEW.[type] != 'CONTAINER'
-    AND
-    NEW.[type] != 'URL'
 BEGIN
-    SELECT RAISE(ABORT, '[type] is invalid');
+    DELETE FROM
+        mm_bookmarks_ancestry
+    WHERE
+        [descendant] = OLD.[identifier]
+        OR
+        [ancestor] = OLD.[identifier];
 END;
     )EOF",
 
 
     R"EOF(
--- [type]
+-- replaces the recursive check of
+-- mm_bookmarks_container_after_update_invalid
 CREATE TRIGGER IF NOT EXISTS
-    mm_bookmarks_type_after_update
-AFTER UPDATE ON
+    mm_bookmarks_container_before_update_cycle
+BEFORE UPDATE OF
+    [container]
+ON
     mm_bookmarks
 WHEN
-    NEW.[type] != OLD.[type]
+    NEW.[container] != OLD.[container]
+    AND
+    EXISTS
+    (
+        SELECT
+            *
+        FROM
+            mm_bookmarks_ancestry
+        WHERE
+            [ancestor] = NEW.[identifier]
+            AND
+            [descendant] = NEW.[container]
+    )
 BEGIN
-    SELECT RAISE(ROLLBACK, '[type] can not be modified');
+    SELECT RAISE(ABORT, '[container] is invalid');
 END;
     )EOF",
 
 
+    "DROP TRIGGER IF EXISTS mm_bookmarks_container_after_update_invalid;",
+
+
+};
+
+
+static std::vector<std::string> const backfill = {
+    "DELETE FROM mm_bookmarks_ancestry;",
+
+
     R"EOF(
--- [created]
-CREATE TRIGGER IF NOT EXISTS
-    mm_bookmarks_created_after_insert
-AFTER INSERT ON
-    mm_bookmarks
-WHEN
-    NEW.[created] IS NULL OR NEW.[created] = ''
-BEGIN
-    UPDATE
+-- backfill
+WITH RECURSIVE
+    cte_ancestry
+    (
+        [ancestor], [descendant], [depth]
+    )
+AS
+(
+    SELECT
+        [identifier], [identifier], 0
+    FROM
+        mm_bookmarks
+
+    UNION ALL
+
+    SELECT
+        cte_ancestry.[ancestor],
+        mm_bookmarks.[identifier],
+        cte_ancestry.[depth] + 1
+    FROM
+        mm_bookmarks
+    JOIN
+        cte_ancestry
+    ON
+        mm_bookmarks.[container] = cte_ancestry.[descendant]
+)
+INSERT INTO
+    mm_bookmarks_ancestry
+    ([ancestor], [descendant], [depth])
+SELECT
+    [ancestor], [descendant], [depth]
+FROM
+    cte_ancestry;
+    )EOF",
+};
+
+
+static std::vector<std::string> const drop = {
+    "DROP TRIGGER IF EXISTS mm_bookmarks_container_before_update_cycle;",
+    "DROP TRIGGER IF EXISTS mm_bookmarks_ancestry_after_insert;",
+    "DROP TRIGGER IF EXISTS mm_bookmarks_ancestry_after_update;",
+    "DROP TRIGGER IF EXISTS mm_bookmarks_ancestry_after_delete;",
+    "DROP TABLE IF EXISTS mm_bookmarks_ancestry;",
+    bookmarks::container_after_update_invalid,
+};
+
+
+static std::string const contains = R"EOF(
+SELECT
+    COUNT(*) AS [count]
+FROM
+    mm_bookmarks_ancestry
+WHERE
+    [ancestor] = :ANCESTOR
+    AND
+    [descendant] = :DESCENDANT;
+    )EOF";
+
+
+// without the closure table
+static std::string const contains_recursive = R"EOF(
+WITH RECURSIVE
+    cte_parents
+    (
+        [identifier], [container]
+    )
+AS
+(
+    SELECT
+        mm_bookmarks.[identifier], mm_bookmarks.[container]
+    FROM
         mm_bookmarks
-    SET
-        [created]  = (strftime('%Y-%m-%dT%H:%M:%S+00:00', 'now'))
     WHERE
-        [identifier] == NEW.[identifier];
-END;
+        mm_bookmarks.[identifier] = :DESCENDANT
+
+    UNION
+
+    SELECT
+        mm_bookmarks.[identifier], mm_bookmarks.[container]
+    FROM
+        mm_bookmarks
+    JOIN
+        cte_parents
+    ON
+        mm_bookmarks.[identifier] = cte_parents.[container]
+)
+SELECT
+    COUNT(*) AS [count]
+FROM
+    cte_parents
+WHERE
+    cte_parents.[identifier] = :ANCESTOR;
+    )EOF";
+
+
+// target of a move and every container above it
+static std::string const ancestors = R"EOF(
+SELECT
+    [ancestor] AS [identifier]
+FROM
+    mm_bookmarks_ancestry
+WHERE
+    [descendant] = :DESCENDANT;
+    )EOF";
+
+
+static std::string const ancestors_recursive = R"EOF(
+WITH RECURSIVE
+    cte_parents
+    (
+        [identifier], [container]
+    )
+AS
+(
+    SELECT
+        mm_bookmarks.[identifier], mm_bookmarks.[container]
+    FROM
+        mm_bookmarks
+    WHERE
+        mm_bookmarks.[identifier] = :DESCENDANT
+
+    UNION
+
+    SELECT
+        mm_bookmarks.[identifier], mm_bookmarks.[container]
+    FROM
+        mm_bookmarks
+    JOIN
+        cte_parents
+    ON
+        mm_bookmarks.[identifier] = cte_parents.[container]
+)
+SELECT
+    [identifier]
+FROM
+    cte_parents;
+    )EOF";
+
+
+static std::string const container_exists = R"EOF(
+SELECT
+    COUNT(*) AS [count]
+FROM
+    mm_bookmarks
+WHERE
+    [identifier] = :IDENTIFIER
+    AND
+    [type] = 'CONTAINER';
+    )EOF";
+} // namespace ancestry
+
+
+namespace search
+{
+static std::string const exists = R"EOF(
+SELECT
+    COUNT(*) AS [count]
+FROM
+    sqlite_master
+WHERE
+    [type] = 'table' AND [name] = 'mm_bookmarks_search';
+    )EOF";
+
+
+static std::vector<std::string> const create = {
+    R"EOF(
+-- external content index, rows are kept in sync by triggers
+CREATE VIRTUAL TABLE IF NOT EXISTS
+mm_bookmarks_search
+USING fts5
+(
+    title,
+    url,
+    note,
+    content = 'mm_bookmarks',
+    content_rowid = 'rowid'
+);
     )EOF",
 
 
     R"EOF(
--- [modified]
 CREATE TRIGGER IF NOT EXISTS
-    mm_bookmarks_modified_after_insert
+    mm_bookmarks_search_after_insert
 AFTER INSERT ON
     mm_bookmarks
-WHEN
-    NEW.[modified] IS NULL OR NEW.[modified] = ''
 BEGIN
-    UPDATE
-        mm_bookmarks
-    SET
-        [modified] = (strftime('%Y-%m-%dT%H:%M:%S+00:00', 'now'))
-    WHERE
-        [identifier] == NEW.[identifier];
+    INSERT INTO
+        mm_bookmarks_search
+        (rowid, title, url, note)
+    VALUES
+        (NEW.rowid, NEW.[title], NEW.[url], NEW.[note]);
 END;
     )EOF",
 
 
     R"EOF(
--- [modified]
 CREATE TRIGGER IF NOT EXISTS
-    mm_bookmarks_modified_after_update
-AFTER UPDATE ON
+    mm_bookmarks_search_after_delete
+AFTER DELETE ON
     mm_bookmarks
 BEGIN
-    UPDATE
-        mm_bookmarks
-    SET
-        [modified] = (strftime('%Y-%m-%dT%H:%M:%S+00:00', 'now'))
-    WHERE
-        [identifier] == NEW.[identifier];
+    INSERT INTO
+        mm_bookmarks_search
+        (mm_bookmarks_search, rowid, title, url, note)
+    VALUES
+        ('delete', OLD.rowid, OLD.[title], OLD.[url], OLD.[note]);
 END;
     )EOF",
 
 
-    // -- reserved bookmarks
     R"EOF(
-INSERT OR IGNORE INTO
+CREATE TRIGGER IF NOT EXISTS
+    mm_bookmarks_search_after_update
+AFTER UPDATE OF
+    [title], [url], [note]
+ON
     mm_bookmarks
-    (
-        [identifier],
-        [container],
-        [type],
-        [title]
-    )
-VALUES
-    ('1', '0', 'CONTAINER', 'MM Bookmarks'),
-    ('2', '1', 'CONTAINER', 'Main Bookmarks'),
-    ('3', '1', 'CONTAINER', 'Other Bookmarks'),
-    ('4', '1', 'CONTAINER', 'Removed Bookmarks');
+BEGIN
+    INSERT INTO
+        mm_bookmarks_search
+        (mm_bookmarks_search, rowid, title, url, note)
+    VALUES
+        ('delete', OLD.rowid, OLD.[title], OLD.[url], OLD.[note]);
+
+    INSERT INTO
+        mm_bookmarks_search
+        (rowid, title, url, note)
+    VALUES
+        (NEW.rowid, NEW.[title], NEW.[url], NEW.[note]);
+END;
     )EOF",
 };
-} // namespace bookmarks
+
+
+// row by row maintenance, dropped around bulk work and rebuilt after
+static std::vector<std::string> const drop_triggers = {
+    "DROP TRIGGER IF EXISTS mm_bookmarks_search_after_insert;",
+    "DROP TRIGGER IF EXISTS mm_bookmarks_search_after_delete;",
+    "DROP TRIGGER IF EXISTS mm_bookmarks_search_after_update;",
+};
+
+
+static std::string const rebuild =
+    "INSERT INTO mm_bookmarks_search (mm_bookmarks_search) VALUES ('rebuild');";
+
+
+// bm25 weights follow column order: title, url, note
+static std::string const query = R"EOF(
+SELECT
+    mm_bookmarks.*,
+    bm25(mm_bookmarks_search, 10.0, 5.0, 1.0) AS [mm_rank],
+    snippet(mm_bookmarks_search, -1, '[', ']', '...', 16) AS [mm_snippet]
+FROM
+    mm_bookmarks_search
+JOIN
+    mm_bookmarks
+ON
+    mm_bookmarks.rowid = mm_bookmarks_search.rowid
+WHERE
+    mm_bookmarks_search MATCH :QUERY
+ORDER BY
+    [mm_rank]
+LIMIT
+    :MLIMIT;
+    )EOF";
+} // namespace search
 
 
 namespace imports
@@ -454,9 +1286,11 @@ tmp_other_entries
     [note]
         TEXT,
     [created]
-        TEXT NOT NULL DEFAULT (strftime('%Y-%m-%dT%H:%M:%S+00:00', 'now')),
+        INTEGER NOT NULL DEFAULT
+        (CAST(ROUND((julianday('now') - 2440587.5) * 86400000) AS INTEGER)),
     [modified]
-        TEXT NOT NULL DEFAULT (strftime('%Y-%m-%dT%H:%M:%S+00:00', 'now')),
+        INTEGER NOT NULL DEFAULT
+        (CAST(ROUND((julianday('now') - 2440587.5) * 86400000) AS INTEGER)),
     FOREIGN KEY ([container])
     REFERENCES tmp_other_entries ([identifier])
     ON UPDATE CASCADE
@@ -603,8 +1437,29 @@ SELECT
     CTEParents.[url],
     CTEParents.[title],
     CTEParents.[note],
-    CTEParents.[created],
-    CTEParents.[modified]
+    -- databases of older schemas keep text timestamps
+    CASE typeof(CTEParents.[created])
+        WHEN 'text' THEN
+            COALESCE
+            (
+                CAST(ROUND((julianday(CTEParents.[created]) - 2440587.5)
+                           * 86400000) AS INTEGER),
+                CAST(ROUND((julianday('now') - 2440587.5) * 86400000)
+                     AS INTEGER)
+            )
+        ELSE CTEParents.[created]
+    END,
+    CASE typeof(CTEParents.[modified])
+        WHEN 'text' THEN
+            COALESCE
+            (
+                CAST(ROUND((julianday(CTEParents.[modified]) - 2440587.5)
+                           * 86400000) AS INTEGER),
+                CAST(ROUND((julianday('now') - 2440587.5) * 86400000)
+                     AS INTEGER)
+            )
+        ELSE CTEParents.[modified]
+    END
 FROM
     CTEParents;
     )EOF",
@@ -951,24 +1806,8 @@ SELECT
     'CONTAINER',
     attached_firefox_database.moz_bookmarks.[title],
     attached_firefox_database.moz_bookmarks.[id],
-    (
-        SELECT
-        (
-            strftime
-            (
-                '%Y-%m-%dT%H:%M:%S+00:00',
-                substr
-                (
-                    attached_firefox_database.moz_bookmarks.[dateAdded]
-                    ||
-                    0000000000,
-                    1,
-                    10
-                ),
-                'unixepoch'
-            )
-        )
-    )
+    -- microseconds to milliseconds
+    attached_firefox_database.moz_bookmarks.[dateAdded] / 1000
 FROM
     attached_firefox_database.moz_bookmarks
 WHERE
@@ -1076,24 +1915,8 @@ SELECT
     attached_firefox_database.moz_bookmarks.[title],
     attached_firefox_database.moz_places.[url],
     attached_firefox_database.moz_places.[description],
-    (
-        SELECT
-        (
-            strftime
-            (
-                '%Y-%m-%dT%H:%M:%S+00:00',
-                substr
-                (
-                    attached_firefox_database.moz_bookmarks.[dateAdded]
-                    ||
-                    0000000000,
-                    1,
-                    10
-                ),
-                'unixepoch'
-            )
-        )
-    )
+    -- microseconds to milliseconds
+    attached_firefox_database.moz_bookmarks.[dateAdded] / 1000
 FROM
     attached_firefox_database.moz_bookmarks
 LEFT JOIN
@@ -0,0 +1,216 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "statement.hh"
+#include <stdexcept>
+
+namespace mm
+{
+namespace bookmarks
+{
+namespace
+{
+thread_local size_t thread_bytes_bound = 0;
+} // namespace
+
+
+statement::statement() = default;
+
+
+statement::~statement()
+{
+    if (m_statement != nullptr)
+        sqlite3_finalize(m_statement);
+}
+
+
+statement::statement(sqlite3* database, std::string const& sql)
+    : m_database {database}, m_sql {sql}
+{
+    if (m_database == nullptr)
+        throw std::runtime_error {"Database need to be opened."};
+
+    if (sqlite3_prepare_v3(m_database,
+                           m_sql.c_str(),
+                           static_cast<int>(m_sql.size() + 1),
+                           SQLITE_PREPARE_PERSISTENT,
+                           &m_statement,
+                           nullptr) != SQLITE_OK)
+        throw std::runtime_error {sqlite3_errmsg(m_database)};
+
+    if (m_statement == nullptr)
+        throw std::runtime_error {"Empty statement."};
+}
+
+
+void statement::bind(sqlite::row const& row_)
+{
+    for (auto const& v : row_.columns())
+    {
+        int const index = parameter_index(v.second.parameter());
+        if (index > 0)
+            bind(index, v.second);
+    }
+}
+
+
+void statement::bind(int const& index, sqlite::column const& column_)
+{
+    std::string const value = column_.value();
+
+    int rc = SQLITE_OK;
+
+    thread_bytes_bound += value.size();
+
+    if (value.empty())
+        rc = sqlite3_bind_null(m_statement, index);
+    else if (column_.type() == sqlite::data_type::INTEGER)
+        rc = sqlite3_bind_int64(m_statement, index, std::stoll(value));
+    else if (column_.type() == sqlite::data_type::REAL)
+        rc = sqlite3_bind_double(m_statement, index, std::stod(value));
+    else
+        rc = sqlite3_bind_text(m_statement,
+                               index,
+                               value.c_str(),
+                               static_cast<int>(value.size()),
+                               SQLITE_TRANSIENT);
+
+    if (rc != SQLITE_OK)
+        throw std::runtime_error {sqlite3_errmsg(m_database)};
+}
+
+
+void statement::bind_text(int const& index, std::string const& value)
+{
+    if (index <= 0)
+        return;
+
+    thread_bytes_bound += value.size();
+
+    if (sqlite3_bind_text(m_statement,
+                          index,
+                          value.c_str(),
+                          static_cast<int>(value.size()),
+                          SQLITE_TRANSIENT) != SQLITE_OK)
+        throw std::runtime_error {sqlite3_errmsg(m_database)};
+}
+
+
+int statement::parameter_index(std::string const& parameter) const
+{
+    if (parameter.empty())
+        return 0;
+    return sqlite3_bind_parameter_index(m_statement,
+                                        (":" + parameter).c_str());
+}
+
+
+bool statement::step()
+{
+    int const rc = sqlite3_step(m_statement);
+
+    if (rc == SQLITE_ROW)
+        return true;
+    if (rc == SQLITE_DONE)
+        return false;
+
+    std::string const message = sqlite3_errmsg(m_database);
+    sqlite3_reset(m_statement);
+    throw std::runtime_error {message};
+}
+
+
+void statement::reset()
+{
+    sqlite3_reset(m_statement);
+    sqlite3_clear_bindings(m_statement);
+}
+
+
+int statement::column_count() const
+{
+    return sqlite3_column_count(m_statement);
+}
+
+
+std::string statement::column_name(int const& index) const
+{
+    char const* name = sqlite3_column_name(m_statement, index);
+    return (name == nullptr) ? std::string {} : std::string {name};
+}
+
+
+std::string statement::column_value(int const& index) const
+{
+    unsigned char const* text = sqlite3_column_text(m_statement, index);
+    if (text == nullptr)
+        return {};
+    return std::string {
+        reinterpret_cast<char const*>(text),
+        static_cast<size_t>(sqlite3_column_bytes(m_statement, index))};
+}
+
+
+sqlite::row statement::row() const
+{
+    sqlite::row result {};
+
+    for (int i = 0; i < column_count(); ++i)
+    {
+        sqlite::data_type type = sqlite::data_type::TEXT;
+
+        switch (sqlite3_column_type(m_statement, i))
+        {
+        case SQLITE_INTEGER:
+            type = sqlite::data_type::INTEGER;
+            break;
+        case SQLITE_FLOAT:
+            type = sqlite::data_type::REAL;
+            break;
+        default:
+            break;
+        }
+
+        result.append(column_name(i), sqlite::column {column_value(i), type});
+    }
+
+    return result;
+}
+
+
+std::vector<sqlite::row> statement::rows()
+{
+    std::vector<sqlite::row> result {};
+
+    while (step())
+        result.push_back(row());
+
+    return result;
+}
+
+
+std::string const& statement::sql() const { return m_sql; }
+
+
+sqlite3_stmt* statement::handle() const { return m_statement; }
+
+
+size_t statement::bytes_bound() { return thread_bytes_bound; }
+} // namespace bookmarks
+} // namespace mm
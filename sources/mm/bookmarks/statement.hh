@@ -0,0 +1,74 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sqlite3.h>
+#include <mm/sqlite/column.hh>
+#include <mm/sqlite/row.hh>
+
+namespace mm
+{
+namespace bookmarks
+{
+// single prepared statement
+// parameters are bound by sqlite::column::parameter(), empty values as NULL
+class statement
+{
+public:
+    statement();
+    ~statement();
+
+    statement(sqlite3* database, std::string const& sql);
+
+    statement(statement const&)            = delete;
+    statement& operator=(statement const&) = delete;
+
+    void bind(sqlite::row const& row_);
+    void bind(int const& index, sqlite::column const& column_);
+    void bind_text(int const& index, std::string const& value);
+    int  parameter_index(std::string const& parameter) const;
+
+    // true while a row is available
+    bool step();
+    void reset();
+
+    int         column_count() const;
+    std::string column_name(int const& index) const;
+    std::string column_value(int const& index) const;
+    sqlite::row row() const;
+
+    std::vector<sqlite::row> rows();
+
+    std::string const& sql() const;
+    sqlite3_stmt*      handle() const;
+
+    // bytes of values bound by any statement on the calling thread
+    static size_t bytes_bound();
+
+
+private:
+    sqlite3*      m_database  = nullptr;
+    sqlite3_stmt* m_statement = nullptr;
+    std::string   m_sql       = {};
+};
+} // namespace bookmarks
+} // namespace mm
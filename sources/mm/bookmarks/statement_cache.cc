@@ -0,0 +1,158 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "statement_cache.hh"
+#include <cctype>
+
+namespace mm
+{
+namespace bookmarks
+{
+statement_cache::statement_cache() = default;
+
+
+statement_cache::~statement_cache() { clear(); }
+
+
+void statement_cache::reset(sqlite3* database)
+{
+    clear();
+    m_database = database;
+    m_hits     = 0;
+    m_misses   = 0;
+}
+
+
+void statement_cache::clear()
+{
+    m_index.clear();
+    m_entries.clear();
+}
+
+
+std::shared_ptr<statement> statement_cache::acquire(std::string const& sql,
+                                                    bool const& normalized)
+{
+    std::string const  normalized_ = normalized ? "" : normalize(sql);
+    std::string const& key         = normalized ? sql : normalized_;
+
+    auto found = m_index.find(key);
+
+    if (found != m_index.end())
+    {
+        m_entries.splice(m_entries.begin(), m_entries, found->second);
+
+        // not in use by anyone else
+        if (found->second->second.use_count() == 1)
+        {
+            ++m_hits;
+            found->second->second->reset();
+            return found->second->second;
+        }
+
+        ++m_misses;
+        return std::make_shared<statement>(m_database, sql);
+    }
+
+    ++m_misses;
+
+    auto stmt = std::make_shared<statement>(m_database, sql);
+
+    if (m_capacity == 0)
+        return stmt;
+
+    m_entries.emplace_front(key, stmt);
+    m_index[key] = m_entries.begin();
+
+    evict();
+
+    return stmt;
+}
+
+
+void statement_cache::capacity(size_t const& capacity_)
+{
+    m_capacity = capacity_;
+    evict();
+}
+
+
+size_t statement_cache::capacity() const { return m_capacity; }
+
+
+size_t statement_cache::size() const { return m_entries.size(); }
+
+
+size_t statement_cache::hits() const { return m_hits; }
+
+
+size_t statement_cache::misses() const { return m_misses; }
+
+
+std::string statement_cache::normalize(std::string const& sql)
+{
+    std::string result {};
+    result.reserve(sql.size());
+
+    bool space = false;
+    char quote = '\0';
+
+    // whitespace inside literals and quoted identifiers is kept as is
+    for (auto const& c : sql)
+    {
+        if (quote != '\0')
+        {
+            result += c;
+            if (c == quote)
+                quote = '\0';
+            continue;
+        }
+
+        if (std::isspace(static_cast<unsigned char>(c)))
+        {
+            space = !result.empty();
+            continue;
+        }
+
+        if (c == '\'' || c == '"')
+            quote = c;
+        else if (c == '[')
+            quote = ']';
+
+        if (space)
+            result += ' ';
+
+        space = false;
+        result += c;
+    }
+
+    return result;
+}
+
+
+void statement_cache::evict()
+{
+    while (m_entries.size() > m_capacity)
+    {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
+} // namespace bookmarks
+} // namespace mm
@@ -0,0 +1,75 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <list>
+#include <memory>
+#include <utility>
+#include <unordered_map>
+#include <sqlite3.h>
+#include "statement.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+// bounded LRU of prepared statements keyed by normalized sql
+// a statement still held by a caller is never handed out twice,
+// a fresh (uncached) one is prepared instead
+class statement_cache
+{
+public:
+    statement_cache();
+    ~statement_cache();
+
+    statement_cache(statement_cache const&)            = delete;
+    statement_cache& operator=(statement_cache const&) = delete;
+
+    void reset(sqlite3* database);
+    void clear();
+
+    // normalized skips normalize(), for sql that already went through it
+    std::shared_ptr<statement> acquire(std::string const& sql,
+                                       bool const&        normalized = false);
+
+    void   capacity(size_t const& capacity_);
+    size_t capacity() const;
+    size_t size() const;
+    size_t hits() const;
+    size_t misses() const;
+
+    static std::string normalize(std::string const& sql);
+
+
+private:
+    using entry = std::pair<std::string, std::shared_ptr<statement>>;
+
+    void evict();
+
+    sqlite3*          m_database = nullptr;
+    size_t            m_capacity = 64;
+    size_t            m_hits     = 0;
+    size_t            m_misses   = 0;
+    std::list<entry>  m_entries  = {};
+    std::unordered_map<std::string, std::list<entry>::iterator> m_index = {};
+};
+} // namespace bookmarks
+} // namespace mm
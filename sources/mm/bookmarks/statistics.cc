@@ -0,0 +1,373 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "statistics.hh"
+#include "statement.hh"
+#include <stdexcept>
+#include <algorithm>
+#include <exception>
+#include <cstdio>
+#include <cmath>
+
+namespace mm
+{
+namespace bookmarks
+{
+statistics::statistics() = default;
+
+
+statistics::~statistics() = default;
+
+
+statistics::operation const& statistics::at(operation_type const& type) const
+{
+    for (auto const& v : operations)
+        if (v.type == type)
+            return v;
+    throw std::runtime_error {"Invalid operation."};
+}
+
+
+std::string statistics::to_text() const
+{
+    std::string result {};
+
+    static auto _number = [](double const& value)
+    {
+        char buffer[32] = {};
+        std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+        return std::string {buffer};
+    };
+
+    auto _metric = [&](std::string const& name,
+                       std::string const& type,
+                       std::string const& help)
+    {
+        result += "# HELP mmbookmarks_" + name + " " + help + "\n";
+        result += "# TYPE mmbookmarks_" + name + " " + type + "\n";
+    };
+
+    auto _sample = [&](std::string const& name,
+                       std::string const& labels,
+                       std::string const& value)
+    {
+        result += "mmbookmarks_" + name +
+                  (labels.empty() ? "" : "{" + labels + "}") + " " + value +
+                  "\n";
+    };
+
+    static auto _label = [](operation const& v)
+    { return "operation=\"" + enum_string(v.type) + "\""; };
+
+    auto _counter = [&](std::string const& name,
+                        std::string const& help,
+                        size_t operation::*member)
+    {
+        _metric(name, "counter", help);
+        for (auto const& v : operations)
+            _sample(name, _label(v), std::to_string(v.*member));
+    };
+
+    _counter("calls_total", "Calls made.", &operation::calls);
+    _counter("errors_total", "Calls left by an exception.", &operation::errors);
+    _counter("rows_in_total", "Rows written.", &operation::rows_in);
+    _counter("rows_out_total", "Rows returned.", &operation::rows_out);
+    _counter("bytes_bound_total", "Bytes bound.", &operation::bytes_bound);
+
+    _metric("latency_seconds", "histogram", "Call latency.");
+
+    for (auto const& v : operations)
+    {
+        size_t cumulative = 0;
+
+        for (auto const& b : v.buckets)
+        {
+            cumulative += b.second;
+            _sample("latency_seconds_bucket",
+                    _label(v) + ",le=\"" + _number(b.first) + "\"",
+                    std::to_string(cumulative));
+        }
+
+        _sample("latency_seconds_bucket",
+                _label(v) + ",le=\"+Inf\"",
+                std::to_string(v.calls));
+        _sample("latency_seconds_sum", _label(v), _number(v.seconds));
+        _sample("latency_seconds_count", _label(v), std::to_string(v.calls));
+    }
+
+    auto _single = [&](std::string const& name,
+                       std::string const& type,
+                       std::string const& help,
+                       std::string const& value)
+    {
+        _metric(name, type, help);
+        _sample(name, "", value);
+    };
+
+    _single("sqlite_cache_hits_total",
+            "counter",
+            "Page cache hits.",
+            std::to_string(cache_hits));
+    _single("sqlite_cache_misses_total",
+            "counter",
+            "Page cache misses.",
+            std::to_string(cache_misses));
+    _single("sqlite_cache_writes_total",
+            "counter",
+            "Pages written.",
+            std::to_string(cache_writes));
+    _single("sqlite_cache_used_bytes",
+            "gauge",
+            "Page cache memory.",
+            std::to_string(cache_used));
+    _single("sqlite_statements_used_bytes",
+            "gauge",
+            "Prepared statement memory.",
+            std::to_string(statements_used));
+    _single("sqlite_schema_used_bytes",
+            "gauge",
+            "Schema memory.",
+            std::to_string(schema_used));
+    _single("sqlite_memory_used_bytes",
+            "gauge",
+            "Memory used by sqlite.",
+            std::to_string(memory_used));
+    _single("sqlite_pagecache_used",
+            "gauge",
+            "Page cache slots in use.",
+            std::to_string(pagecache_used));
+    _single("sqlite_pagecache_overflow_bytes",
+            "gauge",
+            "Page cache overflow.",
+            std::to_string(pagecache_overflow));
+    _single("statement_cache_hits_total",
+            "counter",
+            "Statement cache hits.",
+            std::to_string(statement_cache_hits));
+    _single("statement_cache_misses_total",
+            "counter",
+            "Statement cache misses.",
+            std::to_string(statement_cache_misses));
+    _single("listing_cache_hits_total",
+            "counter",
+            "Listing cache hits.",
+            std::to_string(listing_cache_hits));
+    _single("listing_cache_misses_total",
+            "counter",
+            "Listing cache misses.",
+            std::to_string(listing_cache_misses));
+    _single("listing_cache_evictions_total",
+            "counter",
+            "Listing cache evictions.",
+            std::to_string(listing_cache_evictions));
+
+    return result;
+}
+
+
+latency_histogram::latency_histogram() = default;
+
+
+latency_histogram::~latency_histogram() = default;
+
+
+void latency_histogram::record(std::uint64_t const& nanoseconds)
+{
+    m_counts.at(index(nanoseconds)).fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void latency_histogram::reset()
+{
+    for (auto& v : m_counts)
+        v.store(0, std::memory_order_relaxed);
+}
+
+
+std::array<std::uint64_t, latency_histogram::size>
+    latency_histogram::counts() const
+{
+    std::array<std::uint64_t, size> result {};
+
+    for (size_t i = 0; i < size; ++i)
+        result.at(i) = m_counts.at(i).load(std::memory_order_relaxed);
+
+    return result;
+}
+
+
+size_t latency_histogram::index(std::uint64_t const& nanoseconds)
+{
+    std::uint64_t const value =
+        std::min<std::uint64_t>(nanoseconds, (std::uint64_t {1} << 48) - 1);
+
+    // the first buckets are exact
+    if (value < sub_buckets)
+        return static_cast<size_t>(value);
+
+    size_t msb = 0;
+    for (std::uint64_t v = value; v > 1; v >>= 1)
+        ++msb;
+
+    size_t const shift = msb - 3;
+
+    return (msb - 2) * sub_buckets + ((value >> shift) - sub_buckets);
+}
+
+
+std::uint64_t latency_histogram::upper_bound(size_t const& index)
+{
+    if (index < sub_buckets)
+        return index;
+
+    size_t const shift = index / sub_buckets - 1;
+    size_t const sub   = index % sub_buckets;
+
+    return ((sub_buckets + sub + 1) << shift) - 1;
+}
+
+
+statistics_recorder::scope::scope(statistics_recorder&  recorder,
+                                  operation_type const& type)
+    : m_recorder {&recorder},
+      m_type {type},
+      m_exceptions {std::uncaught_exceptions()},
+      m_bytes {statement::bytes_bound()},
+      m_started {std::chrono::steady_clock::now()}
+{
+}
+
+
+statistics_recorder::scope::~scope()
+{
+    auto const elapsed = std::chrono::steady_clock::now() - m_started;
+
+    m_recorder->record(
+        m_type,
+        static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count()),
+        rows_in,
+        rows_out,
+        statement::bytes_bound() - m_bytes,
+        std::uncaught_exceptions() > m_exceptions);
+}
+
+
+statistics_recorder::statistics_recorder() = default;
+
+
+statistics_recorder::~statistics_recorder() = default;
+
+
+void statistics_recorder::record(operation_type const& type,
+                                 std::uint64_t const&  nanoseconds,
+                                 size_t const&         rows_in,
+                                 size_t const&         rows_out,
+                                 size_t const&         bytes_bound,
+                                 bool const&           failed)
+{
+    counters& c = m_counters.at(static_cast<size_t>(type));
+
+    c.calls.fetch_add(1, std::memory_order_relaxed);
+    c.errors.fetch_add(failed ? 1 : 0, std::memory_order_relaxed);
+    c.rows_in.fetch_add(rows_in, std::memory_order_relaxed);
+    c.rows_out.fetch_add(rows_out, std::memory_order_relaxed);
+    c.bytes_bound.fetch_add(bytes_bound, std::memory_order_relaxed);
+    c.nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    c.latency.record(nanoseconds);
+}
+
+
+void statistics_recorder::reset()
+{
+    for (auto& c : m_counters)
+    {
+        c.calls.store(0, std::memory_order_relaxed);
+        c.errors.store(0, std::memory_order_relaxed);
+        c.rows_in.store(0, std::memory_order_relaxed);
+        c.rows_out.store(0, std::memory_order_relaxed);
+        c.bytes_bound.store(0, std::memory_order_relaxed);
+        c.nanoseconds.store(0, std::memory_order_relaxed);
+        c.latency.reset();
+    }
+}
+
+
+statistics::operation statistics_recorder::snapshot(
+    operation_type const& type) const
+{
+    counters const& c = m_counters.at(static_cast<size_t>(type));
+
+    statistics::operation result {};
+
+    result.type        = type;
+    result.calls       = c.calls.load(std::memory_order_relaxed);
+    result.errors      = c.errors.load(std::memory_order_relaxed);
+    result.rows_in     = c.rows_in.load(std::memory_order_relaxed);
+    result.rows_out    = c.rows_out.load(std::memory_order_relaxed);
+    result.bytes_bound = c.bytes_bound.load(std::memory_order_relaxed);
+    result.seconds =
+        static_cast<double>(c.nanoseconds.load(std::memory_order_relaxed)) /
+        1e9;
+
+    std::array<std::uint64_t, latency_histogram::size> const counts =
+        c.latency.counts();
+
+    std::uint64_t total = 0;
+    for (auto const& v : counts)
+        total += v;
+
+    static auto _seconds = [](size_t const& index)
+    {
+        return static_cast<double>(latency_histogram::upper_bound(index)) /
+               1e9;
+    };
+
+    // smallest bucket holding at least the given share of calls
+    auto _percentile = [&](double const& share)
+    {
+        std::uint64_t const wanted = static_cast<std::uint64_t>(
+            std::ceil(share * static_cast<double>(total)));
+        std::uint64_t cumulative = 0;
+
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            cumulative += counts.at(i);
+            if (cumulative >= wanted && cumulative > 0)
+                return _seconds(i);
+        }
+
+        return 0.0;
+    };
+
+    result.p50 = _percentile(0.50);
+    result.p90 = _percentile(0.90);
+    result.p99 = _percentile(0.99);
+    result.max = _percentile(1.0);
+
+    for (size_t i = 0; i < counts.size(); ++i)
+        if (counts.at(i) > 0)
+            result.buckets.emplace_back(_seconds(i),
+                                        static_cast<size_t>(counts.at(i)));
+
+    return result;
+}
+} // namespace bookmarks
+} // namespace mm
@@ -0,0 +1,183 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+#include "enums.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+// snapshot taken by manager::stats()
+class statistics
+{
+public:
+    class operation
+    {
+    public:
+        operation_type type   = operation_type::NONE;
+        size_t         calls  = 0;
+        size_t         errors = 0;
+
+        // rows written by the call and rows handed back to the caller
+        size_t rows_in     = 0;
+        size_t rows_out    = 0;
+        size_t bytes_bound = 0;
+        double seconds     = 0.0;
+
+        // bucket upper bounds, at most 12.5% above the recorded value
+        double p50 = 0.0;
+        double p90 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+
+        // upper bound in seconds and count of every non empty bucket
+        std::vector<std::pair<double, size_t>> buckets = {};
+    };
+
+    std::vector<operation> operations = {};
+
+    // sqlite3_db_status of the writer and every reader connection
+    long long cache_hits      = 0;
+    long long cache_misses    = 0;
+    long long cache_writes    = 0;
+    long long cache_used      = 0;
+    long long statements_used = 0;
+    long long schema_used     = 0;
+
+    // sqlite3_status of the process
+    long long memory_used        = 0;
+    long long pagecache_used     = 0;
+    long long pagecache_overflow = 0;
+
+    size_t statement_cache_hits    = 0;
+    size_t statement_cache_misses  = 0;
+    size_t listing_cache_hits      = 0;
+    size_t listing_cache_misses    = 0;
+    size_t listing_cache_evictions = 0;
+
+    statistics();
+    ~statistics();
+
+    operation const& at(operation_type const& type) const;
+
+    // prometheus text exposition format
+    std::string to_text() const;
+};
+
+
+// nanoseconds in log-linear buckets, each power of two split in eight
+class latency_histogram
+{
+public:
+    constexpr static size_t sub_buckets = 8;
+    // values are capped at 2^48 nanoseconds, about three days
+    constexpr static size_t size = (48 - 2) * sub_buckets;
+
+    latency_histogram();
+    ~latency_histogram();
+
+    latency_histogram(latency_histogram const&)            = delete;
+    latency_histogram& operator=(latency_histogram const&) = delete;
+
+    void record(std::uint64_t const& nanoseconds);
+    void reset();
+
+    std::array<std::uint64_t, size> counts() const;
+
+    static size_t        index(std::uint64_t const& nanoseconds);
+    static std::uint64_t upper_bound(size_t const& index);
+
+
+private:
+    std::array<std::atomic<std::uint64_t>, size> m_counts = {};
+};
+
+
+// counters of every operation, updated without locks
+class statistics_recorder
+{
+public:
+    // times one call, recorded as failed when left by an exception
+    class scope
+    {
+    public:
+        size_t rows_in  = 0;
+        size_t rows_out = 0;
+
+        scope(statistics_recorder& recorder, operation_type const& type);
+        ~scope();
+
+        scope(scope const&)            = delete;
+        scope& operator=(scope const&) = delete;
+
+
+    private:
+        statistics_recorder*                  m_recorder   = nullptr;
+        operation_type                        m_type       = {};
+        int                                   m_exceptions = 0;
+        size_t                                m_bytes      = 0;
+        std::chrono::steady_clock::time_point m_started    = {};
+    };
+
+    constexpr static size_t operations =
+        static_cast<size_t>(operation_type::IMPORT) + 1;
+
+    statistics_recorder();
+    ~statistics_recorder();
+
+    statistics_recorder(statistics_recorder const&)            = delete;
+    statistics_recorder& operator=(statistics_recorder const&) = delete;
+
+    void record(operation_type const& type,
+                std::uint64_t const&  nanoseconds,
+                size_t const&         rows_in,
+                size_t const&         rows_out,
+                size_t const&         bytes_bound,
+                bool const&           failed);
+    void reset();
+
+    statistics::operation snapshot(operation_type const& type) const;
+
+
+private:
+    class counters
+    {
+    public:
+        std::atomic<size_t>        calls       = {0};
+        std::atomic<size_t>        errors      = {0};
+        std::atomic<size_t>        rows_in     = {0};
+        std::atomic<size_t>        rows_out    = {0};
+        std::atomic<size_t>        bytes_bound = {0};
+        std::atomic<std::uint64_t> nanoseconds = {0};
+        latency_histogram          latency     = {};
+    };
+
+    std::array<counters, operations> m_counters = {};
+};
+} // namespace bookmarks
+} // namespace mm
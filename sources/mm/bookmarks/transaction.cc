@@ -0,0 +1,95 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "transaction.hh"
+#include <sqlite3.h>
+#include <atomic>
+#include <stdexcept>
+#include <iostream>
+
+namespace mm
+{
+namespace bookmarks
+{
+transaction::transaction(sqlite::database& database) : m_database {database}
+{
+    if (sqlite3_get_autocommit(m_database.handle()) != 0)
+    {
+        m_database.execute("BEGIN IMMEDIATE;");
+        return;
+    }
+
+    static std::atomic<unsigned long> counter {0};
+
+    m_savepoint = "mm_savepoint_" + std::to_string(++counter);
+    m_database.execute("SAVEPOINT " + m_savepoint + ";");
+}
+
+
+transaction::~transaction()
+{
+    if (m_finished)
+        return;
+
+    try
+    {
+        rollback();
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "| Rollback Error : " << e.what() << std::endl;
+    }
+}
+
+
+void transaction::commit()
+{
+    if (m_finished)
+        throw std::runtime_error {"Transaction already finished."};
+
+    // a failed COMMIT leaves the transaction open, the destructor
+    // still has to roll it back
+    if (m_savepoint.empty())
+        m_database.execute("COMMIT;");
+    else
+        m_database.execute("RELEASE SAVEPOINT " + m_savepoint + ";");
+
+    m_finished = true;
+}
+
+
+void transaction::rollback()
+{
+    m_finished = true;
+
+    // RAISE(ROLLBACK) in a trigger already ended the whole transaction
+    if (sqlite3_get_autocommit(m_database.handle()) != 0)
+        return;
+
+    if (m_savepoint.empty())
+    {
+        m_database.execute("ROLLBACK;");
+        return;
+    }
+
+    m_database.execute("ROLLBACK TO SAVEPOINT " + m_savepoint + ";");
+    m_database.execute("RELEASE SAVEPOINT " + m_savepoint + ";");
+}
+} // namespace bookmarks
+} // namespace mm
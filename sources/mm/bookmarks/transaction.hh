@@ -0,0 +1,51 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <mm/sqlite/database.hh>
+
+namespace mm
+{
+namespace bookmarks
+{
+// scoped transaction, rolled back unless committed
+// outermost one is BEGIN IMMEDIATE, nested ones are savepoints
+class transaction
+{
+public:
+    transaction(sqlite::database& database);
+    ~transaction();
+
+    transaction(transaction const&)            = delete;
+    transaction& operator=(transaction const&) = delete;
+
+    void commit();
+
+
+private:
+    void rollback();
+
+    sqlite::database& m_database;
+    std::string       m_savepoint = {};
+    bool              m_finished  = false;
+};
+} // namespace bookmarks
+} // namespace mm
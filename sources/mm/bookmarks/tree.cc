@@ -0,0 +1,88 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "tree.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+tree::tree() = default;
+
+
+tree::~tree() = default;
+
+
+size_t tree::size() const { return m_nodes.size(); }
+
+
+bool tree::empty() const { return m_nodes.empty(); }
+
+
+std::vector<tree::node> const& tree::nodes() const { return m_nodes; }
+
+
+tree::node const& tree::at(size_t const& index) const
+{
+    return m_nodes.at(index);
+}
+
+
+std::string_view tree::field(size_t const& index, size_t const& field_) const
+{
+    std::pair<size_t, size_t> const& v = m_nodes.at(index).fields.at(field_);
+    return std::string_view {m_arena}.substr(v.first, v.second);
+}
+
+
+std::string_view tree::identifier(size_t const& index) const
+{
+    return field(index, 0);
+}
+
+
+std::string_view tree::type(size_t const& index) const
+{
+    return field(index, 2);
+}
+
+
+std::string_view tree::url(size_t const& index) const
+{
+    return field(index, 3);
+}
+
+
+std::string_view tree::title(size_t const& index) const
+{
+    return field(index, 4);
+}
+
+
+bookmark tree::to_bookmark(size_t const& index) const
+{
+    bookmark result {};
+
+    for (size_t f = 0; f < schema::fields.size(); ++f)
+        result.*(schema::fields[f].member) = std::string {field(index, f)};
+
+    return result;
+}
+} // namespace bookmarks
+} // namespace mm
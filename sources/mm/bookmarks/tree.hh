@@ -0,0 +1,80 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <utility>
+#include <string_view>
+#include "bookmark.hh"
+#include "schema.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+// flat subtree, nodes are stored breadth first and linked by index
+// all strings live in one arena
+class tree
+{
+public:
+    constexpr static size_t npos = static_cast<size_t>(-1);
+
+    class node
+    {
+    public:
+        size_t       parent       = npos;
+        size_t       first_child  = npos;
+        size_t       next_sibling = npos;
+        unsigned int depth        = 0;
+
+        // offset and length in arena, in order of schema::fields
+        std::array<std::pair<size_t, size_t>, schema::fields.size()> fields =
+            {};
+    };
+
+    tree();
+    ~tree();
+
+    size_t size() const;
+    bool   empty() const;
+
+    std::vector<node> const& nodes() const;
+    node const&              at(size_t const& index) const;
+
+    // valid as long as the tree is
+    std::string_view field(size_t const& index, size_t const& field_) const;
+    std::string_view identifier(size_t const& index) const;
+    std::string_view type(size_t const& index) const;
+    std::string_view url(size_t const& index) const;
+    std::string_view title(size_t const& index) const;
+
+    bookmark to_bookmark(size_t const& index) const;
+
+
+private:
+    friend class manager;
+
+    std::vector<node> m_nodes = {};
+    std::string       m_arena = {};
+};
+} // namespace bookmarks
+} // namespace mm
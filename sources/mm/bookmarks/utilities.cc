@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <stdexcept>
 #include <cctype>
+#include <cstdio>
 
 namespace mm
 {
@@ -49,6 +50,233 @@ std::string form_parameter(std::string const& name, std::string const& postfix)
 }
 
 
+std::string parameter_list(std::string const& name, size_t const& count)
+{
+    if (count == 0)
+        throw std::runtime_error {"Parameter list can not be empty."};
+
+    std::string result = "(";
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        result += (i > 0) ? ", :" : ":";
+        result += form_parameter(name, std::to_string(i));
+    }
+
+    return result + ")";
+}
+
+
+std::string search_query(std::string const& text)
+{
+    std::string result {};
+    std::string word {};
+
+    static auto _flush = [](std::string& result_, std::string& word_)
+    {
+        if (word_.empty())
+            return;
+        result_ += (result_.empty() ? "\"" : " \"") + word_ + "\"*";
+        word_.clear();
+    };
+
+    for (auto const& c : text)
+    {
+        if (std::isspace(static_cast<unsigned char>(c)))
+            _flush(result, word);
+        else if (c == '"')
+            word += "\"\"";
+        else
+            word += c;
+    }
+
+    _flush(result, word);
+
+    return result;
+}
+
+
+namespace
+{
+// days since 1970-01-01 of a proleptic gregorian date and back
+long long days_from_civil(long long y, unsigned const m, unsigned const d)
+{
+    y -= (m <= 2) ? 1 : 0;
+    long long const era = (y >= 0 ? y : y - 399) / 400;
+    unsigned const  yoe = static_cast<unsigned>(y - era * 400);
+    unsigned const  doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned const  doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<long long>(doe) - 719468;
+}
+
+
+void civil_from_days(long long z, long long& y, unsigned& m, unsigned& d)
+{
+    z += 719468;
+    long long const era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned const  doe = static_cast<unsigned>(z - era * 146097);
+    unsigned const  yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned const  doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned const  mp  = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<long long>(yoe) + era * 400 + (m <= 2 ? 1 : 0);
+}
+} // namespace
+
+
+std::string format_timestamp(long long const& milliseconds)
+{
+    std::string result {};
+    format_timestamp(milliseconds, result);
+    return result;
+}
+
+
+void format_timestamp(long long const& milliseconds, std::string& out)
+{
+    long long const day_ms = 86400000;
+
+    long long days = milliseconds / day_ms;
+    long long rest = milliseconds % day_ms;
+
+    if (rest < 0)
+    {
+        days -= 1;
+        rest += day_ms;
+    }
+
+    long long y = 0;
+    unsigned  m = 0;
+    unsigned  d = 0;
+    civil_from_days(days, y, m, d);
+
+    char buffer[40] = {};
+
+    // the text format predates millisecond storage, which it truncates
+    int const written =
+        std::snprintf(buffer,
+                      sizeof(buffer),
+                      "%04lld-%02u-%02uT%02lld:%02lld:%02lld+00:00",
+                      y,
+                      m,
+                      d,
+                      rest / 3600000,
+                      (rest / 60000) % 60,
+                      (rest / 1000) % 60);
+    out.append(buffer, static_cast<size_t>(written));
+}
+
+
+long long parse_timestamp(std::string const& text)
+{
+    static auto _invalid = []
+    { return std::runtime_error {"Invalid timestamp."}; };
+
+    if (text.empty())
+        throw _invalid();
+
+    if (std::all_of(text.cbegin() + (text.front() == '-' ? 1 : 0),
+                    text.cend(),
+                    [](unsigned char c) { return std::isdigit(c); }))
+    {
+        if (text.size() == 1 && text.front() == '-')
+            throw _invalid();
+        return std::stoll(text);
+    }
+
+    size_t position = 0;
+
+    auto _number = [&](size_t const& digits)
+    {
+        if (position + digits > text.size())
+            throw _invalid();
+
+        long long result = 0;
+
+        for (size_t i = 0; i < digits; ++i, ++position)
+        {
+            if (!std::isdigit(static_cast<unsigned char>(text.at(position))))
+                throw _invalid();
+            result = result * 10 + (text.at(position) - '0');
+        }
+
+        return result;
+    };
+
+    auto _expect = [&](char const& c)
+    {
+        if (position >= text.size() || text.at(position) != c)
+            throw _invalid();
+        ++position;
+    };
+
+    auto _next = [&](char const& c)
+    { return position < text.size() && text.at(position) == c; };
+
+    long long const year = _number(4);
+    _expect('-');
+    long long const month = _number(2);
+    _expect('-');
+    long long const day = _number(2);
+
+    long long hour = 0, minute = 0, second = 0, millisecond = 0, offset = 0;
+
+    if (_next('T') || _next(' '))
+    {
+        ++position;
+        hour = _number(2);
+        _expect(':');
+        minute = _number(2);
+
+        if (_next(':'))
+        {
+            ++position;
+            second = _number(2);
+        }
+
+        // fraction beyond milliseconds is truncated
+        if (_next('.'))
+        {
+            ++position;
+            long long scale = 100;
+            if (position >= text.size() ||
+                !std::isdigit(static_cast<unsigned char>(text.at(position))))
+                throw _invalid();
+            while (position < text.size() &&
+                   std::isdigit(static_cast<unsigned char>(text.at(position))))
+            {
+                millisecond += (text.at(position) - '0') * scale;
+                scale /= 10;
+                ++position;
+            }
+        }
+    }
+
+    if (_next('Z'))
+        ++position;
+    else if (_next('+') || _next('-'))
+    {
+        long long const sign = (text.at(position) == '-') ? -1 : 1;
+        ++position;
+        long long const offset_hour = _number(2);
+        _expect(':');
+        offset = sign * (offset_hour * 60 + _number(2));
+    }
+
+    if (position != text.size() || month < 1 || month > 12 || day < 1 ||
+        day > 31 || hour > 23 || minute > 59 || second > 60)
+        throw _invalid();
+
+    long long const days = days_from_civil(year,
+                                           static_cast<unsigned>(month),
+                                           static_cast<unsigned>(day));
+
+    return ((days * 24 + hour) * 60 + minute - offset) * 60000 +
+           second * 1000 + millisecond;
+}
+
+
 std::string escape_characters(std::string const&              str,
                               std::vector<std::string> const& characters)
 {
@@ -32,6 +32,23 @@ std::string uppercase(std::string const& str);
 std::string form_parameter(std::string const& name, std::string const& postfix);
 
 
+// (:NAME0, :NAME1, ...)
+std::string parameter_list(std::string const& name, size_t const& count);
+
+
+// plain text into an FTS5 query matching every word as a prefix
+std::string search_query(std::string const& text);
+
+
+// epoch milliseconds <=> 2022-01-31T12:30:00+00:00, formatting drops
+// the milliseconds
+std::string format_timestamp(long long const& milliseconds);
+// appends to out, no temporary string for arena fills
+void format_timestamp(long long const& milliseconds, std::string& out);
+// accepts epoch milliseconds or ISO 8601, with or without offset
+long long parse_timestamp(std::string const& text);
+
+
 std::string escape_characters(
     std::string const&              str,
     std::vector<std::string> const& characters = {"'", "\"", ";"});
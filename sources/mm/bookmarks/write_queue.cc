@@ -0,0 +1,289 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "write_queue.hh"
+#include "manager.hh"
+#include <stdexcept>
+#include <utility>
+
+namespace mm
+{
+namespace bookmarks
+{
+write_queue::write_queue(manager&                         manager_,
+                         size_t const&                    max_group,
+                         std::chrono::microseconds const& window)
+    : m_manager {manager_},
+      m_max_group {std::max<size_t>(max_group, 1)},
+      m_window {window}
+{
+    m_writer = std::thread {[this] { run(); }};
+}
+
+
+write_queue::~write_queue() { stop(); }
+
+
+std::future<batch_report>
+    write_queue::insert_bookmarks(std::vector<bookmark> bookmarks)
+{
+    return enqueue([bms = std::move(bookmarks)](manager& m)
+                   { return m.insert_bookmarks(bms); });
+}
+
+
+std::future<batch_report>
+    write_queue::update_bookmarks(std::vector<bookmark> bookmarks)
+{
+    return enqueue([bms = std::move(bookmarks)](manager& m)
+                   { return m.update_bookmarks(bms); });
+}
+
+
+std::future<batch_report>
+    write_queue::delete_bookmarks(std::vector<std::string> identifiers)
+{
+    return enqueue([ids = std::move(identifiers)](manager& m)
+                   { return m.delete_bookmarks(ids); });
+}
+
+
+void write_queue::stop()
+{
+    if (!m_running.exchange(false))
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock {m_wake_mutex};
+        m_wake.notify_one();
+    }
+
+    if (m_writer.joinable())
+        m_writer.join();
+}
+
+
+size_t write_queue::groups() const { return m_groups.load(); }
+
+
+size_t write_queue::operations() const { return m_operations.load(); }
+
+
+std::future<batch_report>
+    write_queue::enqueue(std::function<batch_report(manager&)> work)
+{
+    // the writer does not exit while an enqueue that saw it running is
+    // still pushing, so no accepted operation is left behind
+    m_enqueuing.fetch_add(1);
+
+    if (!m_running.load())
+    {
+        m_enqueuing.fetch_sub(1);
+        throw std::runtime_error {"Write queue is stopped."};
+    }
+
+    auto* op = new operation {};
+    op->work = std::move(work);
+
+    std::future<batch_report> result = op->promise.get_future();
+
+    push(op);
+    m_pending.fetch_add(1);
+    m_enqueuing.fetch_sub(1);
+
+    // writer announces sleep before checking m_pending, no wakeup is lost
+    if (m_sleeping.load())
+    {
+        std::lock_guard<std::mutex> lock {m_wake_mutex};
+        m_wake.notify_one();
+    }
+
+    return result;
+}
+
+
+void write_queue::push(operation* op)
+{
+    op->next.store(nullptr, std::memory_order_relaxed);
+    operation* prev = m_head.exchange(op, std::memory_order_acq_rel);
+    prev->next.store(op, std::memory_order_release);
+}
+
+
+write_queue::operation* write_queue::pop()
+{
+    operation* tail = m_tail;
+    operation* next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &m_stub)
+    {
+        if (next == nullptr)
+            return nullptr;
+        m_tail = next;
+        tail   = next;
+        next   = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next != nullptr)
+    {
+        m_tail = next;
+        return tail;
+    }
+
+    // a producer is between exchange and link
+    if (tail != m_head.load(std::memory_order_acquire))
+        return nullptr;
+
+    push(&m_stub);
+
+    next = tail->next.load(std::memory_order_acquire);
+
+    if (next != nullptr)
+    {
+        m_tail = next;
+        return tail;
+    }
+
+    return nullptr;
+}
+
+
+void write_queue::run()
+{
+    std::vector<operation*> group {};
+
+    auto _ready = [&] { return m_pending.load() > 0 || !m_running.load(); };
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock {m_wake_mutex};
+            m_sleeping.store(true);
+            m_wake.wait(lock, _ready);
+            m_sleeping.store(false);
+        }
+
+        // checked in this order, see enqueue()
+        if (!m_running.load() && m_pending.load() == 0)
+        {
+            if (m_enqueuing.load() == 0 && m_pending.load() == 0)
+                break;
+            std::this_thread::yield();
+            continue;
+        }
+
+        // collect until the group is full or the window closes
+        auto const deadline = std::chrono::steady_clock::now() + m_window;
+
+        while (group.size() < m_max_group)
+        {
+            operation* op = pop();
+
+            if (op != nullptr)
+            {
+                m_pending.fetch_sub(1);
+                group.push_back(op);
+                continue;
+            }
+
+            if (!m_running.load() && m_pending.load() == 0)
+                break;
+            if (std::chrono::steady_clock::now() >= deadline)
+                break;
+
+            // a producer is between push and link
+            if (m_pending.load() > 0)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock {m_wake_mutex};
+            m_sleeping.store(true);
+            m_wake.wait_until(lock, deadline, _ready);
+            m_sleeping.store(false);
+        }
+
+        if (!group.empty())
+            commit(group);
+    }
+}
+
+
+void write_queue::commit(std::vector<operation*>& group)
+{
+    std::vector<batch_report>       reports(group.size());
+    std::vector<std::exception_ptr> errors(group.size());
+
+    static auto _apply = [](manager&                         manager_,
+                            std::vector<operation*> const&   group_,
+                            std::vector<batch_report>&       reports_,
+                            std::vector<std::exception_ptr>& errors_,
+                            size_t const&                    index)
+    {
+        try
+        {
+            reports_.at(index) = group_.at(index)->work(manager_);
+            errors_.at(index)  = nullptr;
+        }
+        catch (...)
+        {
+            errors_.at(index) = std::current_exception();
+        }
+    };
+
+    try
+    {
+        m_manager.atomically(
+            [&]
+            {
+                for (size_t i = 0; i < group.size(); ++i)
+                {
+                    _apply(m_manager, group, reports, errors, i);
+
+                    // RAISE(ROLLBACK) ended the group transaction
+                    if (!m_manager.in_transaction())
+                        throw std::runtime_error {"Group rolled back."};
+                }
+            });
+    }
+    catch (...)
+    {
+        // nothing of the group was kept, apply one by one
+        for (size_t i = 0; i < group.size(); ++i)
+            _apply(m_manager, group, reports, errors, i);
+    }
+
+    for (size_t i = 0; i < group.size(); ++i)
+    {
+        if (errors.at(i))
+            group.at(i)->promise.set_exception(errors.at(i));
+        else
+            group.at(i)->promise.set_value(reports.at(i));
+
+        delete group.at(i);
+    }
+
+    m_groups.fetch_add(1);
+    m_operations.fetch_add(group.size());
+
+    group.clear();
+}
+} // namespace bookmarks
+} // namespace mm
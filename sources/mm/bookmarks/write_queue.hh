@@ -0,0 +1,106 @@
+/*
+ * mmbookmarks
+ * Copyright (C) 2022  Maruf Sarker
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include "bookmark.hh"
+#include "report.hh"
+
+namespace mm
+{
+namespace bookmarks
+{
+class manager;
+
+
+// writes from many threads, committed by one writer thread in groups
+// an operation failing alone does not fail the rest of its group
+class write_queue
+{
+public:
+    write_queue(manager&                         manager_,
+                size_t const&                    max_group = 1024,
+                std::chrono::microseconds const& window =
+                    std::chrono::microseconds {2000});
+    ~write_queue();
+
+    write_queue(write_queue const&)            = delete;
+    write_queue& operator=(write_queue const&) = delete;
+
+    std::future<batch_report> insert_bookmarks(std::vector<bookmark> bookmarks);
+    std::future<batch_report> update_bookmarks(std::vector<bookmark> bookmarks);
+    std::future<batch_report>
+        delete_bookmarks(std::vector<std::string> identifiers);
+
+    // drains pending operations and joins the writer
+    void stop();
+
+    size_t groups() const;
+    size_t operations() const;
+
+
+private:
+    class operation
+    {
+    public:
+        std::function<batch_report(manager&)> work    = {};
+        std::promise<batch_report>            promise = {};
+        std::atomic<operation*>               next    = {nullptr};
+    };
+
+    std::future<batch_report>
+        enqueue(std::function<batch_report(manager&)> work);
+
+    // intrusive multi-producer single-consumer queue
+    void       push(operation* op);
+    operation* pop();
+
+    void run();
+    void commit(std::vector<operation*>& group);
+
+    manager&                        m_manager;
+    size_t const                    m_max_group;
+    std::chrono::microseconds const m_window;
+
+    operation               m_stub = {};
+    std::atomic<operation*> m_head = {&m_stub};
+    operation*              m_tail = &m_stub;
+
+    std::atomic<size_t> m_pending    = {0};
+    std::atomic<size_t> m_enqueuing  = {0};
+    std::atomic<bool>   m_running    = {true};
+    std::atomic<bool>   m_sleeping   = {false};
+    std::atomic<size_t> m_groups     = {0};
+    std::atomic<size_t> m_operations = {0};
+
+    std::mutex              m_wake_mutex = {};
+    std::condition_variable m_wake       = {};
+    std::thread             m_writer     = {};
+};
+} // namespace bookmarks
+} // namespace mm